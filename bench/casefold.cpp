@@ -0,0 +1,92 @@
+// Channel lookup by the server's casemapping, as ServerConnectionPanel
+// does it for every channel message: fold the target into a reused key
+// and find it in a hash map. The previous shape is timed next to it:
+// a case-sensitive std::map keyed by a wide string converted from the
+// UTF-8 target, as its wxString key was. Folding a nick and the
+// highlight check (IrcCaseFold::contains) are timed as well.
+//
+//   casefold [channels] [lookups]
+
+#include "irc_isupport.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double NanosPer(Clock::time_point start, std::size_t count)
+{
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return count ? elapsed.count() / double(count) : 0.0;
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t channels = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+    const std::size_t lookups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+    if (channels == 0 || lookups == 0)
+        return 1;
+
+    IrcCaseFold fold(IrcCaseMapping::Rfc1459);
+    std::vector<std::string> names;
+    std::uint32_t seed = 3;
+    for (std::size_t i = 0; i < channels; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        names.push_back("#Channel" + std::to_string(seed % 100000) + "[" + std::to_string(i) + "]");
+    }
+
+    std::map<std::wstring, int> previous;
+    std::unordered_map<std::string, int> folded;
+    for (const std::string& name : names)
+    {
+        previous[std::wstring(name.begin(), name.end())] = 1;
+        folded[fold.fold(name)] = 1;
+    }
+
+    std::size_t found = 0;
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < lookups; ++i)
+    {
+        const std::string& name = names[i % channels];
+        found += previous.count(std::wstring(name.begin(), name.end()));
+    }
+    double previousLookup = NanosPer(start, lookups);
+
+    std::string key;
+    start = Clock::now();
+    for (std::size_t i = 0; i < lookups; ++i)
+    {
+        fold.foldInto(names[i % channels], key);
+        found += folded.count(key);
+    }
+    double foldedLookup = NanosPer(start, lookups);
+
+    const std::string nick = "SomeLongerNick_42";
+    start = Clock::now();
+    for (std::size_t i = 0; i < lookups; ++i)
+    {
+        fold.foldInto(nick, key);
+        found += static_cast<unsigned char>(key[i % key.size()]);
+    }
+    double foldNick = NanosPer(start, lookups);
+
+    const std::string ownKey = fold.fold("MyNick");
+    const std::string text = "hey everyone, has anyone seen [mynick] around today? the build is green again";
+    start = Clock::now();
+    for (std::size_t i = 0; i < lookups; ++i)
+        found += fold.contains(text, ownKey);
+    double highlight = NanosPer(start, lookups);
+
+    std::printf("%zu channels, %zu lookups (%zu)\n", channels, lookups, found);
+    std::printf("lookup, std::map by wide string (previous): %6.1f ns\n", previousLookup);
+    std::printf("lookup, folded key in unordered_map:        %6.1f ns\n", foldedLookup);
+    std::printf("fold a %zu-byte nick:                        %6.1f ns\n", nick.size(), foldNick);
+    std::printf("highlight check on a %zu-byte line:          %6.1f ns\n", text.size(), highlight);
+    return 0;
+}
@@ -0,0 +1,177 @@
+// A flood of server lines through IRCCore and the IrcEventQueue to a slow
+// GUI. A loopback listener stands in for the server and writes the lines
+// as fast as TCP takes them; the main thread plays the GUI, draining a
+// batch per wakeup and then sleeping as if it were painting. The receive
+// gate should stop reading while the ring is full, so the ring never
+// overflows and every line arrives, in order.
+//
+//   event_queue [lines] [gui sleep per batch, us]
+//
+// Exits non-zero if a line is lost, reordered or overflowed the ring, so
+// it doubles as a test.
+
+#include "irc_core.h"
+#include "irc_event_queue.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Accepts one connection, writes `lines` numbered PRIVMSGs to it, then
+// reads until the client hangs up
+class FloodServer
+{
+public:
+    explicit FloodServer(std::size_t lines)
+        : lines(lines)
+    {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&addr), len) != 0 ||
+            listen(listener, 1) != 0 || getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+        {
+            std::perror("loopback listener");
+            std::exit(1);
+        }
+        port = ntohs(addr.sin_port);
+        thread = std::thread([this]() { run(); });
+    }
+
+    ~FloodServer()
+    {
+        thread.join();
+        close(listener);
+    }
+
+    int getPort() const { return port; }
+
+private:
+    void run()
+    {
+        int s = accept(listener, nullptr, nullptr);
+        std::string out;
+        for (std::size_t i = 0; i < lines; ++i)
+        {
+            out += ":flood!user@example.net PRIVMSG #bench :line " + std::to_string(i) + " of the flood\r\n";
+            if (out.size() > 16384 || i + 1 == lines)
+            {
+                for (std::size_t sent = 0; sent < out.size();)
+                {
+                    long n = send(s, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+                    if (n <= 0)
+                        break;
+                    sent += static_cast<std::size_t>(n);
+                }
+                out.clear();
+            }
+        }
+
+        char buffer[4096];
+        while (recv(s, buffer, sizeof(buffer), 0) > 0)
+        {
+        }
+        close(s);
+    }
+
+    std::size_t lines;
+    int listener = -1;
+    int port = 0;
+    std::thread thread;
+};
+
+int main(int argc, char** argv)
+{
+    const std::size_t lines = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const long guiSleepUs = argc > 2 ? std::strtol(argv[2], nullptr, 10) : 2000;
+
+    FloodServer server(lines);
+    IrcEventQueue queue;
+    IRCCore core;
+
+    // What the panel does with CallAfter(): one wakeup per scheduled drain
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::size_t scheduled = 0;
+    auto push = [&](IrcEvent event) {
+        if (queue.push(std::move(event)))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++scheduled;
+            wake.notify_one();
+        }
+    };
+
+    core.setRawLineCallback([&](const IrcMessage& msg) {
+        IrcEvent event;
+        event.line = IrcLine(msg);
+        push(std::move(event));
+    });
+    core.setDisconnectCallback([&]() {
+        IrcEvent event;
+        event.type = IrcEvent::Type::Disconnected;
+        push(std::move(event));
+    });
+    core.setReceiveGate([&]() { return queue.hasRoom(); });
+    core.connectToServer("127.0.0.1", server.getPort(), "bench");
+
+    std::vector<IrcEvent> batch;
+    std::size_t received = 0;
+    std::size_t wakeups = 0;
+    bool inOrder = true;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(60);
+    while (received < lines)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!wake.wait_until(lock, deadline, [&]() { return scheduled > 0; }))
+                break;
+            --scheduled;
+        }
+
+        ++wakeups;
+        bool more = queue.drain(batch, 512);
+        core.resumeReceiving();
+        if (more)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++scheduled;
+        }
+
+        for (const IrcEvent& event : batch)
+        {
+            const IrcMessage& msg = event.line.message();
+            if (event.type != IrcEvent::Type::Line || msg.command != "PRIVMSG")
+                continue;
+            std::string text(msg.param(1));
+            if (std::strtoul(text.c_str() + 5, nullptr, 10) != received)
+                inOrder = false;
+            ++received;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(guiSleepUs));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    core.disconnect();
+
+    IrcEventQueue::Stats stats = queue.stats();
+    std::printf("%zu of %zu lines in %.2f s, %zu GUI wakeups, %s\n", received, lines, elapsed.count(), wakeups,
+                inOrder ? "in order" : "OUT OF ORDER");
+    std::printf("ring: capacity %zu, high water %zu, overflowed %llu, dropped %llu\n", stats.capacity,
+                stats.highWater, static_cast<unsigned long long>(stats.overflowed),
+                static_cast<unsigned long long>(stats.dropped));
+    return received == lines && inOrder && stats.overflowed == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// Time AppendIrcFormattedText() on plain and on heavily formatted lines.
+// Built three times from the same source (see CMakeLists.txt): with the
+// AVX2 scan, with the SSE2 one, and with ASTRA_LOG_SCALAR for the portable
+// eight-bytes-at-a-time scan, so one machine can compare all three.
+//
+//   format_parse [lines]
+
+#include "LogFormat.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Mirrors the choice made in LogFormat.cpp, which is built with the same flags
+#if defined(ASTRA_LOG_SCALAR)
+static const char* const ScanName = "scalar";
+#elif defined(__AVX2__)
+static const char* const ScanName = "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+static const char* const ScanName = "SSE2";
+#else
+static const char* const ScanName = "scalar";
+#endif
+
+// Chat without formatting codes, from short replies to long paragraphs
+static std::vector<std::string> PlainLines(std::size_t count)
+{
+    static const char* const words[] = { "the", "build", "seems", "faster", "today,", "did", "anyone",
+                                         "try", "it", "on", "windows", "yet?", "mine", "crashed", "once" };
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::string line;
+        std::size_t length = 20 + (i * 37) % 400;
+        for (std::size_t w = i; line.size() < length; ++w)
+        {
+            line += words[w % (sizeof(words) / sizeof(words[0]))];
+            line += ' ';
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+// The same lines with colours, bold, italics and resets every few words
+static std::vector<std::string> MixedLines(const std::vector<std::string>& plain)
+{
+    static const char* const codes[] = { "\x02", "\x03" "4", "\x03" "12,1", "\x1D", "\x0F", "\x1F", "\x04" "FF8800" };
+    std::vector<std::string> lines;
+    lines.reserve(plain.size());
+    for (std::size_t i = 0; i < plain.size(); ++i)
+    {
+        std::string line;
+        std::size_t spaces = 0;
+        for (char c : plain[i])
+        {
+            line += c;
+            if (c == ' ' && ++spaces % 3 == 0)
+                line += codes[(i + spaces) % (sizeof(codes) / sizeof(codes[0]))];
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+static void Run(const char* title, const std::vector<std::string>& lines)
+{
+    std::size_t bytes = 0;
+    for (const std::string& line : lines)
+        bytes += line.size();
+
+    // Best of a few passes, each over every line
+    double best = 0;
+    std::size_t spans = 0;
+    for (int pass = 0; pass < 5; ++pass)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& text : lines)
+        {
+            LogLine line;
+            AppendIrcFormattedText(line, text);
+            spans += line.spans.size();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (pass == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+
+    std::printf("%-6s %-6s %8.1f ns/line %8.1f MB/s  (%zu spans)\n", ScanName, title,
+                best * 1e9 / double(lines.size()), double(bytes) / best / 1e6, spans / 5);
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+
+    std::vector<std::string> plain = PlainLines(count);
+    std::vector<std::string> mixed = MixedLines(plain);
+    Run("plain", plain);
+    Run("mixed", mixed);
+    return 0;
+}
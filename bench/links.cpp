@@ -0,0 +1,106 @@
+// Link handling in the log: the cost of building a line with
+// AppendIrcFormattedText(), which finds the links in the same pass, for
+// plain lines and for lines with links, and the hover hit test. The hit
+// test is LogLine::UrlAt()'s binary search over the links, timed against
+// scanning the styled runs for the one under the pointer, as the view did
+// before links were recorded.
+//
+//   links [lines]
+
+#include "LogFormat.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double NanosPer(Clock::time_point start, std::size_t count)
+{
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return count ? elapsed.count() / double(count) : 0.0;
+}
+
+// About 80 characters of words, with links mixed in when `withLinks`
+static std::vector<std::string> Lines(std::size_t count, bool withLinks)
+{
+    static const char* const words[] = { "hello", "there", "the", "quick", "brown", "fox", "jumps", "over",
+                                         "lazy", "dog", "channel", "https://example.com/x", "www.test.org" };
+    const std::uint32_t choices = withLinks ? 13 : 11;
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    std::uint32_t seed = 7;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::string line;
+        while (line.size() < 80)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            line += words[(seed >> 8) % choices];
+            line += ' ';
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+static double BuildTime(const std::vector<std::string>& lines, std::size_t& links)
+{
+    auto start = Clock::now();
+    for (const std::string& text : lines)
+    {
+        LogLine line;
+        AppendIrcFormattedText(line, text);
+        links += line.urls.size();
+    }
+    return NanosPer(start, lines.size());
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+    if (count == 0)
+        return 1;
+
+    std::size_t links = 0;
+    double plain = BuildTime(Lines(count, false), links);
+    double linked = BuildTime(Lines(count, true), links);
+
+    // One long line with 200 links in it
+    LogLine big;
+    for (int i = 0; i < 200; ++i)
+        AppendIrcFormattedText(big, "word https://example.com/a ");
+    const std::size_t length = big.text.length();
+
+    const std::size_t probes = 1000000;
+    std::size_t hits = 0;
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < probes; ++i)
+        hits += big.UrlAt(i % length) != nullptr;
+    double binary = NanosPer(start, probes);
+
+    start = Clock::now();
+    for (std::size_t i = 0; i < probes; ++i)
+    {
+        std::size_t offset = i % length;
+        for (const LogSpan& span : big.spans)
+        {
+            if (offset >= span.start && offset < span.start + span.length)
+            {
+                hits += (span.style.Flags() & LogStyle::Url) != 0;
+                break;
+            }
+        }
+    }
+    double scan = NanosPer(start, probes);
+
+    std::printf("%zu lines of ~80 chars (%zu links found)\n", count, links);
+    std::printf("build, plain line:         %7.1f ns\n", plain);
+    std::printf("build, line with links:    %7.1f ns\n", linked);
+    std::printf("hit test, %zu links (%zu runs), %zu hits:\n", big.urls.size(), big.spans.size(), hits);
+    std::printf("  UrlAt binary search:     %7.1f ns\n", binary);
+    std::printf("  scan of the runs:        %7.1f ns\n", scan);
+    return 0;
+}
@@ -0,0 +1,164 @@
+// Times the channel member list at the size of a large channel: finding a
+// member, a PART followed by a JOIN, a rename there and back, reading
+// every row as the nick list does, nick completion and a full NAMES
+// reply. The same work is run on a channel eight times as large, so the
+// cost per operation shows how it grows.
+//
+//   members [count]
+//
+// Exits non-zero if the display order is ever wrong, so it doubles as a
+// test.
+
+#include "ChannelMembers.h"
+#include "UserRegistry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double NanosPer(Clock::time_point start, std::size_t count)
+{
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return count ? elapsed.count() / double(count) : 0.0;
+}
+
+// Highest mode first, then by folded nick
+static bool InOrder(const ChannelMembers& members)
+{
+    auto rank = [&](std::size_t row) {
+        std::uint8_t modes = members.ModesAt(row);
+        int r = 0;
+        while (r < 8 && !(modes & (1u << r)))
+            ++r;
+        return r;
+    };
+    for (std::size_t row = 1; row < members.Size(); ++row)
+    {
+        int before = rank(row - 1);
+        int after = rank(row);
+        if (before > after || (before == after && !(members.UserAt(row - 1).key < members.UserAt(row).key)))
+            return false;
+    }
+    return true;
+}
+
+static bool Run(std::size_t count)
+{
+    // Scattered nicks, about one in twenty opped and one in ten voiced
+    std::vector<std::string> nicks;
+    nicks.reserve(count);
+    std::uint32_t seed = 12345;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        nicks.push_back("User" + std::to_string(seed % 1000000) + "_" + std::to_string(i));
+    }
+    auto modesOf = [](std::size_t i) -> std::uint8_t { return i % 20 == 0 ? 4 : i % 10 == 0 ? 16 : 0; };
+
+    UserRegistry users;
+    ChannelMembers members(users, "#big");
+    bool ok = true;
+
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < count; ++i)
+        members.Add(nicks[i], modesOf(i));
+    double join = NanosPer(start, count);
+    ok = ok && members.Size() == count && InOrder(members);
+
+    const std::size_t ops = 20000;
+    std::size_t found = 0;
+    start = Clock::now();
+    for (std::size_t i = 0; i < ops; ++i)
+        found += members.Contains(nicks[(i * 7919) % count]);
+    double lookup = NanosPer(start, ops);
+    ok = ok && found == ops;
+
+    start = Clock::now();
+    for (std::size_t i = 0; i < ops; ++i)
+    {
+        std::size_t n = (i * 7919) % count;
+        members.Remove(nicks[n]);
+        members.Add(nicks[n], modesOf(n));
+    }
+    double partJoin = NanosPer(start, ops);
+    ok = ok && members.Size() == count && InOrder(members);
+
+    start = Clock::now();
+    for (std::size_t i = 0; i < ops; ++i)
+    {
+        const std::string& nick = nicks[(i * 7919) % count];
+        UserRegistry::UserId id = users.Find(nick);
+        users.Rename(id, "Renamed" + nick);
+        users.Rename(id, nick);
+    }
+    double rename = NanosPer(start, 2 * ops);
+    ok = ok && members.Size() == count && InOrder(members);
+
+    std::size_t length = 0;
+    start = Clock::now();
+    for (std::size_t row = 0; row < members.Size(); ++row)
+        length += members.UserAt(row).nick.size();
+    double row = NanosPer(start, members.Size());
+    ok = ok && length > 0;
+
+    // Completion after 3000 messages, from a broad prefix to a narrow one
+    for (std::size_t i = 0; i < 3000; ++i)
+        members.Spoke(nicks[(i * 104729) % count]);
+    static const char* const prefixes[] = { "user1", "user12", "user1234" };
+    std::vector<UserRegistry::UserId> matches;
+    double complete[3];
+    std::size_t matched[3];
+    for (int p = 0; p < 3; ++p)
+    {
+        const std::size_t rounds = 200;
+        start = Clock::now();
+        for (std::size_t i = 0; i < rounds; ++i)
+            members.Complete(prefixes[p], matches);
+        complete[p] = NanosPer(start, rounds);
+        matched[p] = matches.size();
+        for (std::size_t i = 0; ok && i < matches.size(); ++i)
+            ok = users.Get(matches[i]).key.compare(0, std::strlen(prefixes[p]), prefixes[p]) == 0;
+    }
+
+    std::string names;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (i)
+            names += ' ';
+        if (modesOf(i) == 4)
+            names += '@';
+        else if (modesOf(i) == 16)
+            names += '+';
+        names += nicks[i];
+    }
+    start = Clock::now();
+    members.Assign(names);
+    double assign = NanosPer(start, 1) / 1e6;
+    ok = ok && members.Size() == count && InOrder(members);
+
+    std::printf("%7zu members: join %.0f ns, lookup %.0f ns, part+join %.0f ns, rename %.0f ns, "
+                "row %.0f ns, NAMES %.2f ms\n",
+                count, join, lookup, partJoin, rename, row, assign);
+    for (int p = 0; p < 3; ++p)
+        std::printf("%7s  complete \"%s\": %zu matches, %.0f ns\n", "", prefixes[p], matched[p], complete[p]);
+
+    members.Clear();
+    return ok && users.Size() == 0;
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    if (count == 0)
+        return 1;
+
+    bool ok = Run(count) && Run(count * 8);
+    if (!ok)
+        std::printf("member list out of order or lost members\n");
+    return ok ? 0 : 1;
+}
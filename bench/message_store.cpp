@@ -0,0 +1,110 @@
+// Bytes per stored message and the cost of appending and scanning one
+// column, for chat lines of typical length from a handful of nicks.
+// Appends from nicks already seen should not allocate for the nick; the
+// global operator new is replaced to count allocations per append.
+//
+//   message_store [messages]
+//
+// Exits non-zero if the store loses or garbles a message after dropping
+// and compacting, so it doubles as a test.
+
+#include "MessageStore.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Some past the small-string size, as NICKLEN=30 servers allow
+static const char* const Nicks[] = { "alice", "bob", "carol", "dave",
+                                     "eve", "mallory_the_attacker", "trent", "peggy_the_prover_2024" };
+
+static std::string TextFor(std::size_t i)
+{
+    return "this is message number " + std::to_string(i) + " with some typical chat length text";
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    if (count < 2)
+        return 1;
+
+    std::vector<std::string> texts;
+    texts.reserve(count);
+    std::size_t textBytes = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        texts.push_back(TextFor(i));
+        textBytes += texts.back().size();
+    }
+
+    // Only the first message from each nick, and the columns and arena
+    // growing, may allocate
+    MessageStore store;
+    const std::size_t nickCount = sizeof(Nicks) / sizeof(Nicks[0]);
+    const std::size_t before = allocations;
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::uint8_t flags = i % 50 == 0 ? MessageStore::Highlight : 0;
+        store.Append(1700000000 + static_cast<std::int64_t>(i), MessageKind::Chat, flags, Nicks[i % nickCount], texts[i]);
+    }
+    std::chrono::duration<double, std::nano> append = Clock::now() - start;
+    const std::size_t made = allocations - before;
+
+    // The columns grow by doubling, so the total includes their slack
+    std::size_t columns = store.MessageBytes(0) - store.Text(0).size();
+    std::printf("%zu messages, text %.1f B each: %zu B of columns, %.1f B held per message\n", count,
+                double(textBytes) / double(count), columns, double(store.MemoryUsage()) / double(count));
+    std::printf("append: %.1f ns per message, %.3f allocations per message\n", append.count() / double(count),
+                double(made) / double(count));
+
+    const int passes = 100;
+    std::size_t hits = 0;
+    start = Clock::now();
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        for (std::size_t i = 0; i < store.Size(); ++i)
+            hits += (store.GetFlags(i) & MessageStore::Highlight) != 0;
+    }
+    std::chrono::duration<double, std::nano> scan = Clock::now() - start;
+    std::printf("highlight scan: %.2f ns per message (%zu hits)\n", scan.count() / (double(passes) * double(count)),
+                hits / passes);
+
+    // Drop past the compaction point and check what is left
+    const std::size_t dropped = count / 2 + 1;
+    store.DropFront(dropped);
+    bool ok = store.Size() == count - dropped;
+    for (std::size_t i = 0; ok && i < store.Size(); ++i)
+    {
+        ok = store.Text(i) == texts[dropped + i] && store.NickName(store.Nick(i)) == Nicks[(dropped + i) % nickCount];
+    }
+    if (!ok)
+        std::printf("messages garbled after compaction\n");
+    return ok ? 0 : 1;
+}
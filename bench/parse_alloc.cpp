@@ -0,0 +1,99 @@
+// Counts heap allocations made by IrcMessage::parse(), which is meant to
+// make none: every field is a view into the line. The global operator new
+// is replaced so that any allocation on the way is seen, including ones
+// hidden in the standard library.
+//
+//   parse_alloc [iterations]
+//
+// Exits non-zero if parse() allocated at all, so it doubles as a test.
+
+#include "irc_message.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+// One of each shape the parser has a branch for
+static const char* const Lines[] = {
+    "PING :irc.example.net",
+    ":nick!user@host.example PRIVMSG #channel :hello there, how is everyone?",
+    "@time=2024-01-01T00:00:00.000Z;account=nick :nick!user@host JOIN #channel * :Real Name",
+    ":irc.example.net 353 me = #channel :@op +voice plain ~owner &admin %half",
+    ":irc.example.net 005 me CHANTYPES=# PREFIX=(ov)@+ CASEMAPPING=rfc1459 NETWORK=Example "
+    "NICKLEN=30 CHANNELLEN=50 TOPICLEN=390 AWAYLEN=200 KICKLEN=255 MODES=4 EXCEPTS INVEX "
+    ":are supported by this server",
+    ":server.example 001 me :Welcome",
+    ":nick MODE #channel +ov nick1 nick2",
+    "@+draft/reply=abc;msgid=xyz :nick!user@host NOTICE me :\x02" "bold\x02 and \x03" "4,1colour",
+};
+
+int main(int argc, char** argv)
+{
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    // Own the lines before counting, as the network thread does
+    std::vector<std::string> lines(std::begin(Lines), std::end(Lines));
+
+    IrcMessage msg;
+    std::size_t parsed = 0;
+    std::size_t params = 0;
+
+    const std::size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        for (const std::string& line : lines)
+        {
+            if (IrcMessage::parse(line, msg))
+            {
+                ++parsed;
+                params += msg.paramCount;
+            }
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const std::size_t made = allocations - before;
+
+    std::printf("%zu lines parsed (%zu params) in %.3f s, %.1f ns/line\n", parsed, params,
+                elapsed.count(), parsed ? elapsed.count() * 1e9 / double(parsed) : 0.0);
+    std::printf("heap allocations during parse: %zu\n", made);
+    return made == 0 && parsed == iterations * lines.size() ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Splits the cost of showing a chat line between the two threads, as
+// ServerConnectionPanel does it: the network thread parses the colour
+// codes and links into a FormattedText, and the GUI thread only adds the
+// cached timestamp and copies the runs. Also times the GUI doing all of
+// it, as it did before chat was formatted ahead, so the difference is the
+// GUI time saved per line.
+//
+//   preformat_gui [lines]
+
+#include "LogFormat.h"
+
+#include <wx/datetime.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Short replies, links, heavy formatting and long plain lines in turn
+static std::vector<std::string> ChatLines(std::size_t count)
+{
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::string n = std::to_string(i);
+        switch (i % 4)
+        {
+        case 0:
+            lines.push_back("hey everyone, did anyone try the new build yet? it seems faster " + n);
+            break;
+        case 1:
+            lines.push_back("check https://example.com/some/path?id=" + n + " for details, looks good");
+            break;
+        case 2:
+            lines.push_back("\x02" "bold\x02 and \x03" "04,01red on black\x03 text with \x1D" "italic\x1D bits " + n);
+            break;
+        default:
+            lines.push_back("ok " + n);
+            break;
+        }
+    }
+    return lines;
+}
+
+static double NanosPer(Clock::time_point start, std::size_t count)
+{
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / double(count);
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    if (count == 0)
+        return 1;
+
+    std::vector<std::string> lines = ChatLines(count);
+    std::size_t spans = 0;
+
+    // Before: the GUI thread converts, formats a timestamp and parses
+    auto start = Clock::now();
+    for (const std::string& text : lines)
+    {
+        LogLine line;
+        line.Append(wxDateTime::Now().Format("[%H:%M:%S] "), LogStyle());
+        wxString converted = wxString::FromUTF8(text.data(), text.size());
+        AppendIrcFormattedText(line, text);
+        spans += line.spans.size() + converted.length();
+    }
+    double guiBefore = NanosPer(start, count);
+
+    // Now, network thread: the same as PreformatChat()
+    std::vector<FormattedText> formatted(count);
+    start = Clock::now();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        formatted[i].time = static_cast<std::int64_t>(std::time(nullptr));
+        formatted[i].text = lines[i];
+        AppendIrcFormattedText(formatted[i].body, lines[i]);
+    }
+    double network = NanosPer(start, count);
+
+    // Now, GUI thread: the same as LogPanel::RenderMessage() for chat
+    TimestampFormatter timestamps;
+    start = Clock::now();
+    for (const FormattedText& text : formatted)
+    {
+        LogLine line;
+        line.Append(timestamps.Format(text.time, true), LogStyle());
+        line.Append(text.body);
+        spans += line.spans.size();
+    }
+    double guiNow = NanosPer(start, count);
+
+    std::printf("%zu chat lines (%zu spans)\n", count, spans);
+    std::printf("GUI thread, all work (before): %8.0f ns/line\n", guiBefore);
+    std::printf("network thread, preformat:     %8.0f ns/line\n", network);
+    std::printf("GUI thread, preformatted:      %8.0f ns/line\n", guiNow);
+    std::printf("GUI time saved:                %8.0f ns/line\n", guiBefore - guiNow);
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Enqueue-to-send() latency of IRCCore's outgoing path under load, read
+// back from IRCCore::getSendStats(). A loopback listener stands in for the
+// server and counts the lines that arrive.
+//
+//   send_latency [lines]
+//
+// Two runs: flood control off (the raw cost of queueing, waking the
+// reactor and writing), then on with a fast bucket so that lines of every
+// priority queue up behind it.
+
+#include "irc_core.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Accepts one connection and counts the CRLF-terminated lines on it
+class LoopbackServer
+{
+public:
+    LoopbackServer()
+    {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&addr), len) != 0 ||
+            listen(listener, 1) != 0 || getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+        {
+            std::perror("loopback listener");
+            std::exit(1);
+        }
+        port = ntohs(addr.sin_port);
+        thread = std::thread([this]() { run(); });
+    }
+
+    ~LoopbackServer()
+    {
+        thread.join();
+        close(listener);
+    }
+
+    int getPort() const { return port; }
+    std::size_t getLines() const { return lines.load(); }
+
+private:
+    void run()
+    {
+        int s = accept(listener, nullptr, nullptr);
+        char buffer[65536];
+        long n;
+        while ((n = recv(s, buffer, sizeof(buffer), 0)) > 0)
+        {
+            for (long i = 0; i < n; ++i)
+            {
+                if (buffer[i] == '\n')
+                    lines.fetch_add(1);
+            }
+        }
+        close(s);
+    }
+
+    int listener = -1;
+    int port = 0;
+    std::atomic<std::size_t> lines{ 0 };
+    std::thread thread;
+};
+
+static void printStats(const char* title, const IRCCore::SendStats& stats, double seconds)
+{
+    static const char* const classNames[SendPriorityCount] = { "urgent", "interactive", "bulk" };
+
+    std::printf("%s: %llu lines in %.3f s\n", title,
+                static_cast<unsigned long long>(stats.linesSent), seconds);
+    std::printf("  all          avg %8.1f us  max %8llu us\n",
+                stats.linesSent ? double(stats.totalLatencyUs) / double(stats.linesSent) : 0.0,
+                static_cast<unsigned long long>(stats.maxLatencyUs));
+    for (std::size_t i = 0; i < SendPriorityCount; ++i)
+    {
+        const IRCCore::SendDelay& delay = stats.byPriority[i];
+        std::printf("  %-12s avg %8.1f us  max %8llu us  (%llu lines)\n", classNames[i],
+                    delay.lines ? double(delay.totalUs) / double(delay.lines) : 0.0,
+                    static_cast<unsigned long long>(delay.maxUs),
+                    static_cast<unsigned long long>(delay.lines));
+    }
+    std::printf("  most lines held by flood control at once: %llu\n",
+                static_cast<unsigned long long>(stats.maxLinesHeld));
+}
+
+// Producers enqueue `lines` lines between them, one in ten interactive
+// and the rest bulk, while the reactor drains them to the listener
+static void runLoad(const char* title, const FloodControlSettings& flood, std::size_t lines)
+{
+    constexpr std::size_t Producers = 4;
+    constexpr std::size_t RegistrationLines = 2;  // NICK and USER
+
+    LoopbackServer server;
+    IRCCore core;
+    core.setFloodControl(flood);
+    core.connectToServer("127.0.0.1", server.getPort(), "bench");
+    while (!core.isConnected())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    while (server.getLines() < RegistrationLines)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < Producers; ++p)
+    {
+        producers.emplace_back([&core, p, lines]() {
+            for (std::size_t i = p; i < lines; i += Producers)
+            {
+                if (i % 10 == 0)
+                    core.sendRaw("PRIVMSG #bench :line " + std::to_string(i));
+                else
+                    core.sendRaw("WHO #bench" + std::to_string(i));
+            }
+        });
+    }
+    for (std::thread& producer : producers)
+        producer.join();
+
+    while (server.getLines() < RegistrationLines + lines)
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    IRCCore::SendStats stats = core.getSendStats();
+    core.disconnect();
+    printStats(title, stats, elapsed.count());
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t lines = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+
+    FloodControlSettings off;
+    off.enabled = false;
+    runLoad("flood control off", off, lines);
+
+    // 5-line burst, one more every 2 ms: 500 lines/s
+    FloodControlSettings fast;
+    fast.burstLines = 5;
+    fast.refillIntervalMs = 2;
+    runLoad("flood control 5 + 1/2ms", fast, std::min<std::size_t>(lines, 1000));
+    return 0;
+}
@@ -0,0 +1,242 @@
+// Heap and QUIT/NICK cost of one connection's users: 20k users spread
+// over 50 channels, about three channels each. The UserRegistry with
+// its per-channel ID lists is compared with the layout it replaced, where
+// every channel indexed its own copy of each member's nick. Live heap is
+// counted by replacing the global operator new, and
+// UserRegistry::MemoryUsage() (what /stats shows) is printed next to it.
+//
+//   users [users] [channels]
+
+#include "ChannelMembers.h"
+#include "UserRegistry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Live bytes, tracked through a size header on every block
+static std::size_t liveBytes = 0;
+
+void* operator new(std::size_t size)
+{
+    auto* block = static_cast<std::size_t*>(std::malloc(size + 16));
+    if (!block)
+        throw std::bad_alloc();
+    *block = size;
+    liveBytes += size;
+    return reinterpret_cast<char*>(block) + 16;
+}
+
+void operator delete(void* p) noexcept
+{
+    if (!p)
+        return;
+    auto* block = reinterpret_cast<std::size_t*>(static_cast<char*>(p) - 16);
+    liveBytes -= *block;
+    std::free(block);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+using Clock = std::chrono::steady_clock;
+
+static double NanosPer(Clock::time_point start, std::size_t count)
+{
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return count ? elapsed.count() / double(count) : 0.0;
+}
+
+// The previous layout: each channel a hash index from folded nick to its
+// own member record, plus the display order as pointers
+class PerChannelList
+{
+public:
+    bool Add(const std::string& nick)
+    {
+        auto [it, inserted] = m_members.try_emplace(Fold(nick));
+        if (!inserted)
+            return false;
+        it->second.nick = nick;
+        it->second.key = it->first;
+        m_sorted.insert(Position(&it->second), &it->second);
+        return true;
+    }
+
+    bool Remove(const std::string& nick)
+    {
+        auto it = m_members.find(Fold(nick));
+        if (it == m_members.end())
+            return false;
+        m_sorted.erase(Position(&it->second));
+        m_members.erase(it);
+        return true;
+    }
+
+    bool Rename(const std::string& oldNick, const std::string& newNick)
+    {
+        return Remove(oldNick) && Add(newNick);
+    }
+
+private:
+    struct Member
+    {
+        std::string nick;
+        std::string_view key;
+        std::uint8_t modes = 0;
+    };
+
+    static std::string Fold(std::string key)
+    {
+        for (char& c : key)
+        {
+            if (c >= 'A' && c <= 'Z')
+                c = static_cast<char>(c - 'A' + 'a');
+        }
+        return key;
+    }
+
+    std::vector<const Member*>::iterator Position(const Member* member)
+    {
+        return std::lower_bound(m_sorted.begin(), m_sorted.end(), member,
+                                [](const Member* a, const Member* b) { return a->key < b->key; });
+    }
+
+    std::unordered_map<std::string, Member> m_members;
+    std::vector<const Member*> m_sorted;
+};
+
+// Every user joins three channels picked by a fixed generator, so both
+// layouts see the same memberships
+struct Population
+{
+    std::vector<std::string> nicks;
+    std::vector<std::size_t> channelOf;  // three per user
+
+    Population(std::size_t users, std::size_t channels)
+    {
+        std::uint32_t seed = 1;
+        auto next = [&seed] {
+            seed = seed * 1664525u + 1013904223u;
+            return seed >> 8;
+        };
+        for (std::size_t i = 0; i < users; ++i)
+        {
+            nicks.push_back("user" + std::to_string(next() % 100000) + "_" + std::to_string(i));
+            for (int k = 0; k < 3; ++k)
+                channelOf.push_back(next() % channels);
+        }
+    }
+};
+
+static void Report(const char* title, std::size_t bytes, std::size_t memberships, double quit, double nick)
+{
+    std::printf("%-30s %6.2f MB  %5.1f B/membership  QUIT %6.0f ns  NICK %6.0f ns\n", title,
+                double(bytes) / 1e6, double(bytes) / double(memberships), quit, nick);
+}
+
+static void RunPrevious(const Population& people, std::size_t channels, std::size_t quits)
+{
+    std::size_t base = liveBytes;
+    std::vector<std::unique_ptr<PerChannelList>> lists;
+    for (std::size_t c = 0; c < channels; ++c)
+        lists.push_back(std::make_unique<PerChannelList>());
+
+    std::size_t memberships = 0;
+    for (std::size_t i = 0; i < people.nicks.size(); ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+            memberships += lists[people.channelOf[i * 3 + k]]->Add(people.nicks[i]);
+    }
+    std::size_t bytes = liveBytes - base;
+
+    // Without a user table, both have to ask every channel
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < quits; ++i)
+    {
+        for (auto& list : lists)
+            list->Remove(people.nicks[i]);
+    }
+    double quit = NanosPer(start, quits);
+
+    start = Clock::now();
+    for (std::size_t i = quits; i < 2 * quits; ++i)
+    {
+        for (auto& list : lists)
+            list->Rename(people.nicks[i], people.nicks[i] + "_away");
+    }
+    double nick = NanosPer(start, quits);
+
+    Report("per-channel lists (previous)", bytes, memberships, quit, nick);
+}
+
+static void RunRegistry(const Population& people, std::size_t channels, std::size_t quits, bool addresses)
+{
+    std::size_t base = liveBytes;
+    UserRegistry users;
+    std::vector<std::unique_ptr<ChannelMembers>> lists;
+    for (std::size_t c = 0; c < channels; ++c)
+        lists.push_back(std::make_unique<ChannelMembers>(users, "#channel" + std::to_string(c)));
+
+    std::size_t memberships = 0;
+    for (std::size_t i = 0; i < people.nicks.size(); ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            if (UserRegistry::UserId id = lists[people.channelOf[i * 3 + k]]->Add(people.nicks[i]))
+            {
+                ++memberships;
+                if (addresses)
+                    users.SetAddress(id, "~ident", "host.example.net");
+            }
+        }
+    }
+    std::size_t bytes = liveBytes - base;
+    std::size_t estimate = users.MemoryUsage();
+
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < quits; ++i)
+    {
+        if (UserRegistry::UserId id = users.Find(people.nicks[i]))
+            users.Remove(id);
+    }
+    double quit = NanosPer(start, quits);
+
+    start = Clock::now();
+    for (std::size_t i = quits; i < 2 * quits; ++i)
+    {
+        if (UserRegistry::UserId id = users.Find(people.nicks[i]))
+            users.Rename(id, people.nicks[i] + "_away");
+    }
+    double nick = NanosPer(start, quits);
+
+    Report(addresses ? "registry, with ident/host" : "registry + member lists", bytes, memberships, quit, nick);
+    std::printf("%-30s %6.2f MB  (UserRegistry::MemoryUsage, registry only)\n", "", double(estimate) / 1e6);
+
+    for (auto& list : lists)
+        list->Clear();
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t userCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const std::size_t channels = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+    if (userCount == 0 || channels == 0)
+        return 1;
+
+    Population people(userCount, channels);
+    const std::size_t quits = std::min<std::size_t>(2000, userCount / 2);
+    std::printf("%zu users over %zu channels, three joins each\n", userCount, channels);
+    RunPrevious(people, channels, quits);
+    RunRegistry(people, channels, quits, false);
+    RunRegistry(people, channels, quits, true);
+    return 0;
+}
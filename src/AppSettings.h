@@ -1,5 +1,9 @@
 #pragma once
 
+#include <map>
+#include <string>
+#include "irc_flood_control.h"
+
 // Settings structure shared across the application
 struct AppSettings
 {
@@ -7,4 +11,22 @@ struct AppSettings
     bool use24HourFormat = true;  // true = 24-hour, false = 12-hour
     bool autoReconnect = true;     // Automatically reconnect on disconnect
     int maxReconnectAttempts = 5;  // Max reconnect attempts (0 = unlimited)
+
+    // History kept per tab, in lines and in kilobytes (0 = unlimited), and
+    // for all tabs of all connections together; oldest lines go first
+    int scrollbackLines = 10000;
+    int scrollbackKilobytes = 4096;
+    int scrollbackBudgetMegabytes = 256;
+
+    // Outgoing rate limit; servers with different limits get an entry in
+    // serverFloodControl (keyed by host name as typed when connecting),
+    // set from the Quick Connect dialog
+    FloodControlSettings floodControl;
+    std::map<std::string, FloodControlSettings> serverFloodControl;
+
+    const FloodControlSettings& floodControlFor(const std::string& host) const
+    {
+        auto it = serverFloodControl.find(host);
+        return it != serverFloodControl.end() ? it->second : floodControl;
+    }
 };
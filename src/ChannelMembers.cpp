@@ -0,0 +1,418 @@
+#include "ChannelMembers.h"
+
+#include <algorithm>
+
+// Members without a prefix mode sort after everyone with one
+static int Rank(std::uint8_t modes)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        if (modes & (1u << i))
+            return i;
+    }
+    return 8;
+}
+
+// Treap priority: IDs are handed out in join order, which says nothing
+// about nick order, so a good mix of the ID is as good as a random draw
+static std::uint32_t Priority(UserRegistry::UserId id)
+{
+    std::uint32_t h = id;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+ChannelMembers::ChannelMembers(UserRegistry& users, std::string name)
+    : m_users(users),
+      m_name(std::move(name))
+{
+}
+
+void ChannelMembers::SetPrefixSymbols(std::string_view symbols)
+{
+    m_prefixSymbols.assign(symbols.substr(0, 8));
+}
+
+std::uint8_t ChannelMembers::TakePrefixes(std::string_view& nick) const
+{
+    // Servers with multi-prefix send every mode held, not just the highest
+    std::uint8_t modes = 0;
+    while (!nick.empty())
+    {
+        std::size_t bit = m_prefixSymbols.find(nick.front());
+        if (bit == std::string::npos)
+            break;
+        modes |= static_cast<std::uint8_t>(1u << bit);
+        nick.remove_prefix(1);
+    }
+    return modes;
+}
+
+char ChannelMembers::PrefixSymbol(std::uint8_t modes) const
+{
+    auto rank = static_cast<std::size_t>(Rank(modes));
+    return rank < m_prefixSymbols.size() ? m_prefixSymbols[rank] : 0;
+}
+
+ChannelMembers::UserId ChannelMembers::Add(std::string_view nick, std::uint8_t modes)
+{
+    if (nick.empty())
+        return UserRegistry::NoUser;
+
+    UserId id = m_users.Intern(nick);
+    if (m_users.FindMembership(id, this))
+        return UserRegistry::NoUser;
+
+    m_users.AddMembership(id, this, modes);
+    Link(id);
+    return id;
+}
+
+bool ChannelMembers::Remove(std::string_view nick)
+{
+    UserId id = m_users.Find(nick);
+    return id != UserRegistry::NoUser && Remove(id);
+}
+
+bool ChannelMembers::Remove(UserId id)
+{
+    if (!m_users.FindMembership(id, this))
+        return false;
+
+    // Unlink first: it needs the user's key, which the registry drops
+    // along with a user leaving its last channel
+    Unlink(id);
+    m_users.RemoveMembership(id, this);
+    return true;
+}
+
+bool ChannelMembers::Contains(std::string_view nick) const
+{
+    UserId id = m_users.Find(nick);
+    return id != UserRegistry::NoUser && m_users.FindMembership(id, this);
+}
+
+void ChannelMembers::Clear()
+{
+    std::vector<UserId> ids;
+    CollectMembers(ids);
+    for (UserId id : ids)
+        m_users.RemoveMembership(id, this);
+
+    m_nodes.resize(1);
+    m_freeNodes.clear();
+    m_root = 0;
+}
+
+void ChannelMembers::Spoke(std::string_view nick)
+{
+    UserId id = m_users.Find(nick);
+    if (UserRegistry::Membership* membership = id ? m_users.FindMembership(id, this) : nullptr)
+        membership->spoke = ++m_messages;
+}
+
+template <typename Pred>
+std::size_t ChannelMembers::CountBefore(Pred before) const
+{
+    std::size_t count = 0;
+    std::uint32_t node = m_root;
+    while (node)
+    {
+        const Node& n = m_nodes[node];
+        if (before(n.id))
+        {
+            count += m_nodes[n.left].size + 1;
+            node = n.right;
+        }
+        else
+            node = n.left;
+    }
+    return count;
+}
+
+void ChannelMembers::Complete(std::string_view prefix, std::vector<UserId>& matches) const
+{
+    matches.clear();
+    std::string key = m_users.Fold(prefix);
+
+    // The display order is one run per rank, each sorted by key, so the
+    // matches are one range in every run
+    for (int rank = 0; rank <= 8; ++rank)
+    {
+        std::size_t row = CountBefore([this, rank, &key](UserId id) {
+            int r = Rank(Modes(id));
+            return r < rank || (r == rank && m_users.Get(id).key < key);
+        });
+        for (; row < Size(); ++row)
+        {
+            UserId id = At(row);
+            if (Rank(Modes(id)) != rank || m_users.Get(id).key.compare(0, key.size(), key) != 0)
+                break;
+            matches.push_back(id);
+        }
+    }
+
+    // Only those heard from need ordering by recency; usually a few of them
+    auto heard = std::stable_partition(matches.begin(), matches.end(),
+                                       [this](UserId id) { return LastSpoke(id) != 0; });
+    std::sort(matches.begin(), heard, [this](UserId a, UserId b) { return LastSpoke(a) > LastSpoke(b); });
+}
+
+void ChannelMembers::Assign(std::string_view names)
+{
+    std::size_t count = static_cast<std::size_t>(std::count(names.begin(), names.end(), ' ')) + 1;
+    std::vector<UserId> ids;
+    ids.reserve(count);
+    m_users.Reserve(count);
+    while (!names.empty())
+    {
+        std::size_t end = names.find(' ');
+        std::string_view entry = names.substr(0, end);
+        names.remove_prefix(end == std::string_view::npos ? names.size() : end + 1);
+
+        std::uint8_t modes = TakePrefixes(entry);
+        if (entry.empty())
+            continue;
+
+        UserId id = m_users.Intern(entry);
+        if (UserRegistry::Membership* membership = m_users.FindMembership(id, this))
+            membership->modes = modes;
+        else
+            m_users.AddMembership(id, this, modes);
+        ids.push_back(id);
+    }
+
+    // Whoever was here but is not listed has left
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    std::vector<UserId> previous;
+    CollectMembers(previous);
+    for (UserId id : previous)
+    {
+        if (!std::binary_search(ids.begin(), ids.end(), id))
+            m_users.RemoveMembership(id, this);
+    }
+
+    Rebuild(std::move(ids));
+}
+
+ChannelMembers::UserId ChannelMembers::At(std::size_t row) const
+{
+    std::uint32_t node = m_root;
+    for (;;)
+    {
+        const Node& n = m_nodes[node];
+        std::size_t leftSize = m_nodes[n.left].size;
+        if (row < leftSize)
+            node = n.left;
+        else if (row == leftSize)
+            return n.id;
+        else
+        {
+            row -= leftSize + 1;
+            node = n.right;
+        }
+    }
+}
+
+void ChannelMembers::Link(UserId id)
+{
+    std::uint32_t node = NewNode(id);
+    std::uint32_t before = 0;
+    std::uint32_t rest = 0;
+    Split(m_root, id, before, rest);
+    m_root = Merge(Merge(before, node), rest);
+}
+
+void ChannelMembers::Unlink(UserId id)
+{
+    m_root = Erase(m_root, id);
+}
+
+void ChannelMembers::Resort()
+{
+    std::vector<UserId> ids;
+    CollectMembers(ids);
+    Rebuild(std::move(ids));
+}
+
+std::uint32_t ChannelMembers::NewNode(UserId id)
+{
+    std::uint32_t node;
+    if (!m_freeNodes.empty())
+    {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    }
+    else
+    {
+        node = static_cast<std::uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    m_nodes[node] = Node{ id, 0, 0, 1 };
+    return node;
+}
+
+void ChannelMembers::Update(std::uint32_t node)
+{
+    Node& n = m_nodes[node];
+    n.size = m_nodes[n.left].size + m_nodes[n.right].size + 1;
+}
+
+void ChannelMembers::Split(std::uint32_t node, UserId id, std::uint32_t& before, std::uint32_t& rest)
+{
+    // Into the members ordered before `id` and the rest
+    if (!node)
+    {
+        before = rest = 0;
+        return;
+    }
+
+    Node& n = m_nodes[node];
+    if (Before(n.id, id))
+    {
+        Split(n.right, id, n.right, rest);
+        before = node;
+    }
+    else
+    {
+        Split(n.left, id, before, n.left);
+        rest = node;
+    }
+    Update(node);
+}
+
+std::uint32_t ChannelMembers::Merge(std::uint32_t first, std::uint32_t second)
+{
+    // Every member of `first` comes before every member of `second`
+    if (!first || !second)
+        return first ? first : second;
+
+    if (Priority(m_nodes[first].id) > Priority(m_nodes[second].id))
+    {
+        m_nodes[first].right = Merge(m_nodes[first].right, second);
+        Update(first);
+        return first;
+    }
+    m_nodes[second].left = Merge(first, m_nodes[second].left);
+    Update(second);
+    return second;
+}
+
+std::uint32_t ChannelMembers::Erase(std::uint32_t node, UserId id)
+{
+    // Keys are unique, so the search lands on the member itself
+    if (!node)
+        return 0;
+
+    Node& n = m_nodes[node];
+    if (n.id == id)
+    {
+        std::uint32_t merged = Merge(n.left, n.right);
+        n = Node();
+        m_freeNodes.push_back(node);
+        return merged;
+    }
+
+    if (Before(id, n.id))
+        n.left = Erase(n.left, id);
+    else
+        n.right = Erase(n.right, id);
+    Update(node);
+    return node;
+}
+
+std::uint32_t ChannelMembers::Recount(std::uint32_t node)
+{
+    if (!node)
+        return 0;
+    Node& n = m_nodes[node];
+    n.size = Recount(n.left) + Recount(n.right) + 1;
+    return n.size;
+}
+
+void ChannelMembers::CollectMembers(std::vector<UserId>& ids) const
+{
+    // In no particular order
+    ids.reserve(Size());
+    for (std::size_t node = 1; node < m_nodes.size(); ++node)
+    {
+        if (m_nodes[node].id != UserRegistry::NoUser)
+            ids.push_back(m_nodes[node].id);
+    }
+}
+
+void ChannelMembers::Rebuild(std::vector<UserId> ids)
+{
+    // Sort (rank, key) pairs gathered once rather than calling Before(),
+    // which looks up both users' modes and keys on every comparison. The
+    // rank and the key's first seven bytes are packed into one integer, so
+    // most comparisons never touch the key strings.
+    struct Entry
+    {
+        std::uint64_t head;
+        const std::string* key;
+        UserId id;
+    };
+
+    std::vector<Entry> entries;
+    entries.reserve(ids.size());
+    for (UserId id : ids)
+    {
+        const std::string& key = m_users.Get(id).key;
+        std::uint64_t head = static_cast<std::uint64_t>(Rank(Modes(id))) << 56;
+        for (std::size_t i = 0; i < 7 && i < key.size(); ++i)
+            head |= static_cast<std::uint64_t>(static_cast<unsigned char>(key[i])) << (48 - 8 * i);
+        entries.push_back(Entry{ head, &key, id });
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.head != b.head ? a.head < b.head : *a.key < *b.key;
+    });
+
+    // Build the treap straight from the sorted members, keeping the right
+    // spine on a stack: linear, with no comparisons at all
+    m_nodes.assign(1, Node());
+    m_nodes.reserve(entries.size() + 1);
+    m_freeNodes.clear();
+    std::vector<std::uint32_t> spine;
+    for (const Entry& entry : entries)
+    {
+        std::uint32_t node = NewNode(entry.id);
+        std::uint32_t last = 0;
+        while (!spine.empty() && Priority(m_nodes[spine.back()].id) < Priority(entry.id))
+        {
+            last = spine.back();
+            spine.pop_back();
+        }
+        m_nodes[node].left = last;
+        if (!spine.empty())
+            m_nodes[spine.back()].right = node;
+        spine.push_back(node);
+    }
+    m_root = spine.empty() ? 0 : spine.front();
+    Recount(m_root);
+}
+
+std::uint8_t ChannelMembers::Modes(UserId id) const
+{
+    const UserRegistry::Membership* membership = m_users.FindMembership(id, this);
+    return membership ? membership->modes : 0;
+}
+
+std::uint32_t ChannelMembers::LastSpoke(UserId id) const
+{
+    const UserRegistry::Membership* membership = m_users.FindMembership(id, this);
+    return membership ? membership->spoke : 0;
+}
+
+bool ChannelMembers::Before(UserId a, UserId b) const
+{
+    int rankA = Rank(Modes(a));
+    int rankB = Rank(Modes(b));
+    return rankA < rankB || (rankA == rankB && m_users.Get(a).key < m_users.Get(b).key);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "UserRegistry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// -------------------------------------------------------
+// ChannelMembers
+// Who is in one channel, in display order (highest prefix mode first,
+// then by nick) for the nick list, which reads its visible rows straight
+// out of it. Members are user IDs from the connection's UserRegistry,
+// which holds each user's nick once and knows which channels it is in, so
+// finding a member is one hash lookup. The order is a treap of 16-byte
+// nodes, each counting its subtree, so a join, part or rename and reading
+// the member at a row are all O(log n) however large the channel is.
+//
+// The registry must outlive every list using it; close a channel with
+// Clear() so the registry stops referring to it.
+// -------------------------------------------------------
+
+class ChannelMembers
+{
+public:
+    using UserId = UserRegistry::UserId;
+
+    ChannelMembers(UserRegistry& users, std::string name);
+    ChannelMembers(const ChannelMembers&) = delete;
+    ChannelMembers& operator=(const ChannelMembers&) = delete;
+
+    // Channel name, UTF-8
+    const std::string& Name() const { return m_name; }
+
+    // Prefix symbols, highest first
+    void SetPrefixSymbols(std::string_view symbols);
+
+    // Strip the prefix symbols from the front of a NAMES entry and return
+    // the modes they stand for
+    std::uint8_t TakePrefixes(std::string_view& nick) const;
+
+    // Symbol of the highest mode held, or 0 for none
+    char PrefixSymbol(std::uint8_t modes) const;
+
+    // NoUser if the nick was already here
+    UserId Add(std::string_view nick, std::uint8_t modes = 0);
+
+    // False if the user was not here
+    bool Remove(std::string_view nick);
+    bool Remove(UserId id);
+
+    bool Contains(std::string_view nick) const;
+    void Clear();
+
+    // Note a message from a member, for completion
+    void Spoke(std::string_view nick);
+
+    // Nick completion: members whose nick starts with the prefix (in the
+    // server's casemapping), most recent speakers first, then in display
+    // order
+    void Complete(std::string_view prefix, std::vector<UserId>& matches) const;
+
+    // NAMES: make the members exactly the space-separated, prefixed
+    // entries of a whole reply, sorting once. Members who stay keep their
+    // user (and its address); the rest leave.
+    void Assign(std::string_view names);
+
+    // Members in display order
+    std::size_t Size() const { return m_nodes[m_root].size; }
+    UserId At(std::size_t row) const;
+    const UserRegistry::User& UserAt(std::size_t row) const { return m_users.Get(At(row)); }
+    std::uint8_t ModesAt(std::size_t row) const { return Modes(At(row)); }
+
+    const UserRegistry& Users() const { return m_users; }
+
+private:
+    friend class UserRegistry;
+
+    // Take a member out of / put it back into the display order (around
+    // a rename, which changes its sort key)
+    void Link(UserId id);
+    void Unlink(UserId id);
+
+    // After the registry re-keyed its users
+    void Resort();
+
+    std::uint8_t Modes(UserId id) const;
+    std::uint32_t LastSpoke(UserId id) const;
+    bool Before(UserId a, UserId b) const;
+
+    // Treap nodes by index; 0 is the empty tree. A node's heap priority is
+    // a hash of its user ID, so nothing else needs storing.
+    struct Node
+    {
+        UserId id = UserRegistry::NoUser;  // NoUser while on the free list
+        std::uint32_t left = 0;
+        std::uint32_t right = 0;
+        std::uint32_t size = 0;
+    };
+
+    std::uint32_t NewNode(UserId id);
+    void Update(std::uint32_t node);
+    void Split(std::uint32_t node, UserId id, std::uint32_t& before, std::uint32_t& rest);
+    std::uint32_t Merge(std::uint32_t first, std::uint32_t second);
+    std::uint32_t Erase(std::uint32_t node, UserId id);
+    std::uint32_t Recount(std::uint32_t node);
+
+    // Replace the whole order with these members, sorting them once
+    void Rebuild(std::vector<UserId> ids);
+    void CollectMembers(std::vector<UserId>& ids) const;
+
+    // How many members come first in display order; `before` must hold for
+    // a prefix of them
+    template <typename Pred>
+    std::size_t CountBefore(Pred before) const;
+
+    UserRegistry& m_users;
+    std::string m_name;
+    std::vector<Node> m_nodes{ Node() };
+    std::vector<std::uint32_t> m_freeNodes;
+    std::uint32_t m_root = 0;
+    std::uint32_t m_messages = 0;
+    std::string m_prefixSymbols = "~&@%+";
+};
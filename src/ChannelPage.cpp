@@ -3,8 +3,8 @@
 #include "ServerConnectionPanel.h"
 
 #include <wx/datetime.h>
-#include <wx/richtext/richtextctrl.h>
 #include <wx/utils.h>
+#include <algorithm>
 #include <vector>
 
 // -------- LogPanel --------
@@ -12,179 +12,18 @@
 LogPanel::LogPanel(wxWindow* parent, const AppSettings* settings, ServerConnectionPanel* serverPanel)
     : wxPanel(parent, wxID_ANY),
       m_settings(settings),
-      m_serverPanel(serverPanel),
-      m_defaultForeground(wxColour(220, 220, 220)),
-      m_defaultBackground(wxColour(30, 30, 30))
+      m_serverPanel(serverPanel)
 {
-    m_log = new wxRichTextCtrl(this, wxID_ANY, wxEmptyString,
-        wxDefaultPosition, wxDefaultSize,
-        wxTE_READONLY | wxTE_MULTILINE | wxVSCROLL | wxTE_RICH2);
-
-    // Make absolutely sure it's not editable
-    m_log->SetEditable(false);
-
-    // Set dark background and default colors
-    m_log->SetBackgroundColour(m_defaultBackground);
-
-    // Use a monospace font for better readability
-    wxFont font(10, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
-
-    // Set default text style
-    wxRichTextAttr defaultStyle;
-    defaultStyle.SetTextColour(m_defaultForeground);
-    defaultStyle.SetBackgroundColour(m_defaultBackground);
-    defaultStyle.SetFont(font);
-    m_log->SetBasicStyle(defaultStyle);
-
-    // Hide caret by preventing focus
-    m_log->SetWindowStyleFlag(m_log->GetWindowStyleFlag() | wxTE_PROCESS_TAB);
+    // Owner-drawn and virtualized: only what is on screen gets laid out,
+    // so appends stay cheap however long the history grows
+    m_log = new LogView(this, wxID_ANY);
+    m_log->SetBacklogTrimmer([this](std::size_t bytes) { return TrimBacklog(bytes); });
+    SetSettings(settings);
 
     auto* sizer = new wxBoxSizer(wxVERTICAL);
     sizer->Add(m_log, 1, wxEXPAND | wxALL, 2);
     SetSizer(sizer);
 
-    // Block ALL key events to prevent any editing
-    m_log->Bind(wxEVT_KEY_DOWN, [this](wxKeyEvent&) {
-        // Consume all key events and redirect to input
-        if (m_serverPanel) {
-            wxTextCtrl* input = m_serverPanel->GetInputCtrl();
-            if (input && !input->HasFocus()) {
-                input->SetFocus();
-            }
-        }
-        // Don't skip - consume the event to prevent any editing
-    });
-
-    // ALSO block CHAR events - critical to prevent text insertion!
-    m_log->Bind(wxEVT_CHAR, [this](wxKeyEvent&) {
-        // Consume char events too - this prevents text from being inserted
-        if (m_serverPanel) {
-            wxTextCtrl* input = m_serverPanel->GetInputCtrl();
-            if (input && !input->HasFocus()) {
-                input->SetFocus();
-            }
-        }
-        // Don't skip - consume to prevent editing
-    });
-
-    // Handle mouse clicks for URL detection
-    m_log->Bind(wxEVT_LEFT_UP, [this](wxMouseEvent& evt) {
-        // Check if user was selecting text (don't treat as URL click)
-        long selStart, selEnd;
-        m_log->GetSelection(&selStart, &selEnd);
-        if (selStart != selEnd) {
-            evt.Skip();
-            return;
-        }
-
-        // Get click position using HitTest
-        wxPoint pt = evt.GetPosition();
-        wxTextCoord col, row;
-        wxTextCtrlHitTestResult result = m_log->HitTest(pt, &col, &row);
-
-        if (result == wxTE_HT_UNKNOWN || result == wxTE_HT_BEYOND) {
-            evt.Skip();
-            return;
-        }
-
-        // Get the line text at this row
-        wxString lineText = m_log->GetLineText(row);
-
-        // Simple URL detection
-        int httpPos = lineText.Find("http://");
-        int httpsPos = lineText.Find("https://");
-        int wwwPos = lineText.Find("www.");
-
-        int urlStart = -1;
-        if (httpPos != wxNOT_FOUND) urlStart = httpPos;
-        else if (httpsPos != wxNOT_FOUND) urlStart = httpsPos;
-        else if (wwwPos != wxNOT_FOUND) urlStart = wwwPos;
-
-        if (urlStart != -1) {
-            // Find end of URL
-            int urlEnd = lineText.find_first_of(" \t\n\r", urlStart);
-            wxString url = (urlEnd == wxNOT_FOUND) ? lineText.Mid(urlStart) : lineText.Mid(urlStart, urlEnd - urlStart);
-
-            // Clean up trailing punctuation (but not domain extensions!)
-            while (!url.IsEmpty() && (url.Last() == ',' ||
-                   url.Last() == ')' || url.Last() == ']' || url.Last() == '}')) {
-                url.RemoveLast();
-            }
-
-            // Add protocol if needed
-            if (url.StartsWith("www.")) {
-                url = "http://" + url;
-            }
-
-            if (!url.IsEmpty()) {
-                wxLaunchDefaultBrowser(url);
-                return;
-            }
-        }
-
-        evt.Skip();
-    });
-
-    // Change cursor to hand over URLs - check character position precisely
-    m_log->Bind(wxEVT_MOTION, [this](wxMouseEvent& evt) {
-        wxPoint pt = evt.GetPosition();
-        wxTextCoord col, row;
-        wxTextCtrlHitTestResult result = m_log->HitTest(pt, &col, &row);
-
-        wxStockCursor desiredCursor = wxCURSOR_ARROW;
-
-        if (result != wxTE_HT_UNKNOWN && result != wxTE_HT_BEYOND) {
-            // Convert row to position
-            long lineStart = m_log->XYToPosition(0, row);
-            if (lineStart >= 0) {
-                // Get the line at this row
-                wxString lineText = m_log->GetLineText(row);
-
-                // Find URLs in the line and check if cursor is over one
-                bool overURL = false;
-
-                // Find all URLs in line
-                size_t searchPos = 0;
-                while (searchPos < lineText.length()) {
-                    int httpPos = lineText.find("http://", searchPos);
-                    int httpsPos = lineText.find("https://", searchPos);
-                    int wwwPos = lineText.find("www.", searchPos);
-
-                    int foundPos = -1;
-                    if (httpPos != wxNOT_FOUND) foundPos = httpPos;
-                    if (httpsPos != wxNOT_FOUND && (foundPos == -1 || httpsPos < foundPos)) foundPos = httpsPos;
-                    if (wwwPos != wxNOT_FOUND && (foundPos == -1 || wwwPos < foundPos)) foundPos = wwwPos;
-
-                    if (foundPos == -1) break;
-
-                    // Find end of URL
-                    int urlEnd = lineText.find_first_of(" \t\n\r", foundPos);
-                    if (urlEnd == wxNOT_FOUND) urlEnd = lineText.length();
-
-                    // Check if cursor is within this URL range (use col for position in line)
-                    if (col >= foundPos && col < urlEnd) {
-                        overURL = true;
-                        break;
-                    }
-
-                    searchPos = urlEnd;
-                }
-
-                if (overURL) {
-                    desiredCursor = wxCURSOR_HAND;
-                }
-            }
-        }
-
-        // Only change cursor if it's different from current
-        if (desiredCursor != m_currentCursor) {
-            m_currentCursor = desiredCursor;
-            m_log->SetCursor(wxCursor(m_currentCursor));
-        }
-
-        evt.Skip();
-    });
-
     // CRITICAL: Prevent log area from ever holding focus
     m_log->Bind(wxEVT_SET_FOCUS, [this](wxFocusEvent&) {
         if (m_serverPanel) {
@@ -198,498 +37,411 @@ LogPanel::LogPanel(wxWindow* parent, const AppSettings* settings, ServerConnecti
     });
 }
 
-// IRC color palette (mIRC standard colors)
-wxColour LogPanel::GetIRCColor(int colorCode)
+LogStyle LogPanel::PlainStyle(std::uint32_t colour, std::uint8_t flags) const
 {
-    static const wxColour IRC_COLORS[] = {
-        wxColour(255, 255, 255),  // 0  - White
-        wxColour(0,   0,   0),    // 1  - Black
-        wxColour(0,   0,   127),  // 2  - Blue
-        wxColour(0,   147, 0),    // 3  - Green
-        wxColour(255, 0,   0),    // 4  - Red
-        wxColour(127, 0,   0),    // 5  - Brown/Maroon
-        wxColour(156, 0,   156),  // 6  - Purple
-        wxColour(252, 127, 0),    // 7  - Orange
-        wxColour(255, 255, 0),    // 8  - Yellow
-        wxColour(0,   252, 0),    // 9  - Light Green
-        wxColour(0,   147, 147),  // 10 - Cyan
-        wxColour(0,   255, 255),  // 11 - Light Cyan
-        wxColour(0,   0,   252),  // 12 - Light Blue
-        wxColour(255, 0,   255),  // 13 - Pink/Magenta
-        wxColour(127, 127, 127),  // 14 - Gray
-        wxColour(210, 210, 210)   // 15 - Light Gray
-    };
-
-    if (colorCode >= 0 && colorCode < 16)
-        return IRC_COLORS[colorCode];
-
-    return m_defaultForeground;  // Default if out of range
+    return LogStyle::FromRgb(colour, flags);
 }
 
-// Parse IRC color codes from text
-void LogPanel::ParseIRCColors(const wxString& input, std::vector<IRCTextSegment>& segments)
+void LogPanel::AddMessage(MessageKind kind, const wxString& nick, const wxString& text,
+                          std::shared_ptr<const FormattedText> formatted)
 {
-    IRCTextSegment current;
-    size_t i = 0;
+    // A preformatted message brings its text as received, its time and
+    // its highlight test
+    wxScopedCharBuffer nickUtf8 = nick.ToUTF8();
+    std::string_view nickView(nickUtf8.data(), nickUtf8.length());
+    wxScopedCharBuffer textUtf8;
+    std::string_view textView;
+    std::int64_t time;
+    if (formatted)
+    {
+        textView = formatted->text;
+        time = formatted->time;
+    }
+    else
+    {
+        textUtf8 = text.ToUTF8();
+        textView = std::string_view(textUtf8.data(), textUtf8.length());
+        time = static_cast<std::int64_t>(wxDateTime::Now().GetTicks());
+    }
 
-    while (i < input.length())
+    std::uint8_t flags = 0;
+    if (m_serverPanel && !nickView.empty())
     {
-        wxChar ch = input[i];
+        if (m_serverPanel->IsOwnNick(nickView))
+            flags |= MessageStore::Self;
+        else if (formatted ? formatted->highlight : m_serverPanel->MentionsOwnNick(textView))
+            flags |= MessageStore::Highlight;
+    }
 
-        // Color code: \x03
-        if (ch == 0x03)
-        {
-            // Save current segment if it has text
-            if (!current.text.IsEmpty())
-            {
-                segments.push_back(current);
-                current.text.Clear();
-            }
+    std::size_t index = m_store.Append(time, kind, flags, nickView, textView);
 
-            i++;
-
-            // Check if followed by color number
-            if (i < input.length() && wxIsdigit(input[i]))
-            {
-                // Parse foreground color (1-2 digits)
-                wxString fgStr;
-                while (i < input.length() && wxIsdigit(input[i]) && fgStr.length() < 2)
-                {
-                    fgStr += input[i++];
-                }
-
-                long fg;
-                if (fgStr.ToLong(&fg))
-                {
-                    current.foreground = GetIRCColor(fg);
-                    current.useDefaultFg = false;
-                }
-
-                // Check for background color (comma followed by 1-2 digits)
-                if (i < input.length() && input[i] == ',')
-                {
-                    i++;
-                    wxString bgStr;
-                    while (i < input.length() && wxIsdigit(input[i]) && bgStr.length() < 2)
-                    {
-                        bgStr += input[i++];
-                    }
-
-                    long bg;
-                    if (bgStr.ToLong(&bg))
-                    {
-                        current.background = GetIRCColor(bg);
-                        current.useDefaultBg = false;
-                    }
-                }
-            }
-            else
-            {
-                // \x03 alone resets colors
-                current.foreground = m_defaultForeground;
-                current.background = m_defaultBackground;
-                current.useDefaultFg = true;
-                current.useDefaultBg = true;
-            }
-        }
-        // Bold: \x02
-        else if (ch == 0x02)
-        {
-            if (!current.text.IsEmpty())
-            {
-                segments.push_back(current);
-                current.text.Clear();
-            }
-            current.bold = !current.bold;
-            i++;
-        }
-        // Italic: \x1D
-        else if (ch == 0x1D)
-        {
-            if (!current.text.IsEmpty())
-            {
-                segments.push_back(current);
-                current.text.Clear();
-            }
-            current.italic = !current.italic;
-            i++;
-        }
-        // Underline: \x1F
-        else if (ch == 0x1F)
-        {
-            if (!current.text.IsEmpty())
-            {
-                segments.push_back(current);
-                current.text.Clear();
-            }
-            current.underline = !current.underline;
-            i++;
-        }
-        // Reset: \x0F
-        else if (ch == 0x0F)
-        {
-            if (!current.text.IsEmpty())
-            {
-                segments.push_back(current);
-                current.text.Clear();
-            }
-            current.foreground = m_defaultForeground;
-            current.background = m_defaultBackground;
-            current.bold = false;
-            current.italic = false;
-            current.underline = false;
-            current.useDefaultFg = true;
-            current.useDefaultBg = true;
-            i++;
-        }
-        else
+    if (m_active)
+    {
+        m_log->AppendLine(RenderMessage(index, formatted.get()), m_store.MessageBytes(index));
+        SyncStoreWithView();
+        return;
+    }
+
+    // Nobody is looking: keep it, and its formatted body, for when the
+    // tab is shown
+    ++m_pending;
+    m_pendingFormatted.push_back(std::move(formatted));
+    m_pendingBytes += PendingBytes(m_pending - 1);
+    if (kind == MessageKind::Chat || kind == MessageKind::Notice || kind == MessageKind::Action)
+        ++m_unread;
+
+    // Once the backlog alone fills the scrollback, none of what the view
+    // holds would survive the catch-up, and older backlog never will be
+    // shown at all
+    std::size_t maxLines = m_settings ? static_cast<std::size_t>(std::max(m_settings->scrollbackLines, 0)) : 0;
+    if (maxLines && m_pending > maxLines)
+    {
+        if (m_log->GetLineCount())
         {
-            current.text += ch;
-            i++;
+            m_log->Clear();
+            SyncStoreWithView();
         }
+        DropPending(m_pending - maxLines);
     }
 
-    // Add final segment
-    if (!current.text.IsEmpty())
-        segments.push_back(current);
+    // The byte limit and the shared budget hold it to the same bound,
+    // taking the view's lines first and then the backlog (TrimBacklog)
+    m_log->SetBacklogBytes(m_pendingBytes);
+    SyncStoreWithView();
 }
 
-// Helper to detect if text contains a URL
-bool ContainsURL(const wxString& text) {
-    return text.Find("http://") != wxNOT_FOUND ||
-           text.Find("https://") != wxNOT_FOUND ||
-           text.Find("www.") != wxNOT_FOUND ||
-           text.Find("ftp://") != wxNOT_FOUND;
+void LogPanel::SyncStoreWithView()
+{
+    // The view enforces the scrollback limits; one line per message, so
+    // whatever it dropped from the top is dropped here too
+    std::size_t held = m_log->GetLineCount() + m_pending;
+    if (m_store.Size() > held)
+        m_store.DropFront(m_store.Size() - held);
+
+    // The nick table is no one message's; the view charges it as a whole,
+    // and trims for it when it grows
+    m_log->SetSharedBytes(m_store.NickTableBytes());
+    held = m_log->GetLineCount() + m_pending;
+    if (m_store.Size() > held)
+        m_store.DropFront(m_store.Size() - held);
 }
 
-// Append text with IRC color codes parsed and URLs styled
-void LogPanel::AppendIRCStyledText(const wxString& text)
+std::size_t LogPanel::PendingBytes(std::size_t pendingIndex) const
 {
-    std::vector<IRCTextSegment> segments;
-    ParseIRCColors(text, segments);
-
-    for (const auto& seg : segments)
+    // The stored message, plus the formatted body held until it is rendered
+    std::size_t bytes = m_store.MessageBytes(m_store.Size() - m_pending + pendingIndex) +
+                        sizeof(std::shared_ptr<const FormattedText>);
+    if (const FormattedText* formatted = m_pendingFormatted[pendingIndex].get())
     {
-        // Check if this segment contains a URL
-        if (ContainsURL(seg.text))
-        {
-            // Split and style URLs within this segment
-            wxString remaining = seg.text;
-            while (!remaining.IsEmpty())
-            {
-                int urlPos = -1;
-                wxString protocol;
-
-                // Find URL start
-                int httpPos = remaining.Find("http://");
-                int httpsPos = remaining.Find("https://");
-                int wwwPos = remaining.Find("www.");
-                int ftpPos = remaining.Find("ftp://");
-
-                if (httpPos != wxNOT_FOUND) { urlPos = httpPos; protocol = "http://"; }
-                if (httpsPos != wxNOT_FOUND && (urlPos == -1 || httpsPos < urlPos)) { urlPos = httpsPos; protocol = "https://"; }
-                if (wwwPos != wxNOT_FOUND && (urlPos == -1 || wwwPos < urlPos)) { urlPos = wwwPos; protocol = "www."; }
-                if (ftpPos != wxNOT_FOUND && (urlPos == -1 || ftpPos < urlPos)) { urlPos = ftpPos; protocol = "ftp://"; }
-
-                if (urlPos == -1)
-                {
-                    // No URL found, write remaining text with normal style
-                    wxRichTextAttr attr;
-                    if (!seg.useDefaultFg)
-                        attr.SetTextColour(seg.foreground);
-                    else
-                        attr.SetTextColour(m_defaultForeground);
-                    if (!seg.useDefaultBg)
-                        attr.SetBackgroundColour(seg.background);
-                    wxFont font(10, wxFONTFAMILY_TELETYPE,
-                               seg.italic ? wxFONTSTYLE_ITALIC : wxFONTSTYLE_NORMAL,
-                               seg.bold ? wxFONTWEIGHT_BOLD : wxFONTWEIGHT_NORMAL,
-                               seg.underline);
-                    attr.SetFont(font);
-                    m_log->BeginStyle(attr);
-                    m_log->WriteText(remaining);
-                    m_log->EndStyle();
-                    break;
-                }
-
-                // Write text before URL
-                if (urlPos > 0)
-                {
-                    wxRichTextAttr attr;
-                    if (!seg.useDefaultFg)
-                        attr.SetTextColour(seg.foreground);
-                    else
-                        attr.SetTextColour(m_defaultForeground);
-                    if (!seg.useDefaultBg)
-                        attr.SetBackgroundColour(seg.background);
-                    wxFont font(10, wxFONTFAMILY_TELETYPE,
-                               seg.italic ? wxFONTSTYLE_ITALIC : wxFONTSTYLE_NORMAL,
-                               seg.bold ? wxFONTWEIGHT_BOLD : wxFONTWEIGHT_NORMAL,
-                               seg.underline);
-                    attr.SetFont(font);
-                    m_log->BeginStyle(attr);
-                    m_log->WriteText(remaining.Mid(0, urlPos));
-                    m_log->EndStyle();
-                }
-
-                // Find URL end
-                int urlEnd = remaining.find_first_of(" \t\n\r", urlPos);
-                wxString url = (urlEnd == wxNOT_FOUND) ? remaining.Mid(urlPos) : remaining.Mid(urlPos, urlEnd - urlPos);
-
-                // Clean trailing punctuation (but not domain extensions!)
-                while (!url.IsEmpty() && (url.Last() == ',' ||
-                       url.Last() == ')' || url.Last() == ']' || url.Last() == '}')) {
-                    url.RemoveLast();
-                }
-
-                // Style URL with bright blue color and underline
-                wxRichTextAttr urlAttr;
-                urlAttr.SetTextColour(wxColour(80, 160, 255));  // Bright blue
-                wxFont urlFont(10, wxFONTFAMILY_TELETYPE,
-                              wxFONTSTYLE_NORMAL,
-                              seg.bold ? wxFONTWEIGHT_BOLD : wxFONTWEIGHT_NORMAL,
-                              true);  // underlined = true
-                urlAttr.SetFont(urlFont);
-                m_log->BeginStyle(urlAttr);
-                m_log->WriteText(url);
-                m_log->EndStyle();
-
-                // Update remaining
-                remaining = (urlEnd == wxNOT_FOUND) ? "" : remaining.Mid(urlEnd);
-            }
-        }
-        else
-        {
-            // Normal segment without URL
-            wxRichTextAttr attr;
-            if (!seg.useDefaultFg)
-                attr.SetTextColour(seg.foreground);
-            else
-                attr.SetTextColour(m_defaultForeground);
-            if (!seg.useDefaultBg)
-                attr.SetBackgroundColour(seg.background);
-            wxFont font(10, wxFONTFAMILY_TELETYPE,
-                       seg.italic ? wxFONTSTYLE_ITALIC : wxFONTSTYLE_NORMAL,
-                       seg.bold ? wxFONTWEIGHT_BOLD : wxFONTWEIGHT_NORMAL,
-                       seg.underline);
-            attr.SetFont(font);
-            m_log->BeginStyle(attr);
-            m_log->WriteText(seg.text);
-            m_log->EndStyle();
-        }
+        bytes += sizeof(FormattedText) + formatted->text.capacity() +
+                 (formatted->body.text.length() + 1) * sizeof(wxStringCharType) +
+                 formatted->body.spans.capacity() * sizeof(LogSpan) +
+                 formatted->body.urls.capacity() * sizeof(LogUrl);
     }
+    return bytes;
 }
 
-void LogPanel::AppendSystemMessage(const wxString& message)
+std::size_t LogPanel::DropPending(std::size_t count)
 {
-    // CRITICAL: Always append at the end, not at click position
-    m_log->SetInsertionPointEnd();
-
-    // Add timestamp if enabled
-    if (m_settings && m_settings->showTimestamps)
-    {
-        wxString format = m_settings->use24HourFormat ? "[%H:%M:%S] " : "[%I:%M:%S %p] ";
-        wxString timestamp = wxDateTime::Now().Format(format);
-        m_log->BeginTextColour(wxColour(128, 128, 128));  // Gray
-        m_log->WriteText(timestamp);
-        m_log->EndTextColour();
-    }
+    // Only once the view is empty are the oldest pending messages at the
+    // front of the store
+    count = std::min(count, m_pending);
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        bytes += PendingBytes(i);
+
+    m_store.DropFront(count);
+    m_pendingFormatted.erase(m_pendingFormatted.begin(), m_pendingFormatted.begin() + static_cast<std::ptrdiff_t>(count));
+    m_pending -= count;
+    m_pendingBytes -= bytes;
+    return bytes;
+}
 
-    m_log->BeginTextColour(wxColour(100, 200, 100));  // Light green
-    m_log->WriteText(message + "\n");
-    m_log->EndTextColour();
-    m_log->ShowPosition(m_log->GetLastPosition());
+std::size_t LogPanel::TrimBacklog(std::size_t bytes)
+{
+    // Called by the view once it has dropped every line; the newest
+    // message stays, as the newest line would
+    SyncStoreWithView();
+
+    std::size_t count = 0;
+    std::size_t freed = 0;
+    while (count + 1 < m_pending && freed < bytes)
+        freed += PendingBytes(count++);
+    return DropPending(count);
 }
 
-void LogPanel::AppendErrorMessage(const wxString& message)
+LogLine LogPanel::RenderMessage(std::size_t index, const FormattedText* formatted) const
 {
-    // CRITICAL: Always append at the end, not at click position
-    m_log->SetInsertionPointEnd();
+    // Shared by every log; GUI thread only
+    static TimestampFormatter timestamps;
+
+    LogLine line;
 
     // Add timestamp if enabled
-    if (m_settings && m_settings->showTimestamps)
+    if (m_renderTimestamps)
+        line.Append(timestamps.Format(m_store.Time(index), m_render24Hour), PlainStyle(LogRgb(128, 128, 128)));  // Gray
+
+    std::string_view nickUtf8 = m_store.NickName(m_store.Nick(index));
+    wxString nick = wxString::FromUTF8(nickUtf8.data(), nickUtf8.size());
+
+    // A preformatted body replaces the stored text, and chat is parsed
+    // straight from the stored UTF-8
+    std::string_view textUtf8 = m_store.Text(index);
+    MessageKind kind = m_store.Kind(index);
+    wxString text;
+    if (!formatted && kind != MessageKind::Chat)
+        text = wxString::FromUTF8(textUtf8.data(), textUtf8.size());
+
+    switch (kind)
     {
-        wxString format = m_settings->use24HourFormat ? "[%H:%M:%S] " : "[%I:%M:%S %p] ";
-        wxString timestamp = wxDateTime::Now().Format(format);
-        m_log->BeginTextColour(wxColour(128, 128, 128));  // Gray
-        m_log->WriteText(timestamp);
-        m_log->EndTextColour();
+    case MessageKind::System:
+        line.Append(text, PlainStyle(LogRgb(100, 200, 100)));  // Light green
+        break;
+
+    case MessageKind::Error:
+        line.Append(text, PlainStyle(LogRgb(255, 100, 100), LogStyle::Bold));  // Light red
+        break;
+
+    case MessageKind::Chat:
+        // Format: <nick> message
+        line.Append("<", PlainStyle(LogDefaultForeground));
+        line.Append(nick, PlainStyle(LogRgb(100, 200, 255), LogStyle::Bold));  // Light cyan/blue
+        line.Append("> ", PlainStyle(LogDefaultForeground));
+
+        // Message might contain IRC color codes
+        if (formatted)
+            line.Append(formatted->body);
+        else
+            AppendIrcFormattedText(line, textUtf8);
+        break;
+
+    case MessageKind::Notice:
+        // Format: -nick- message
+        line.Append("-", PlainStyle(LogRgb(255, 180, 80)));  // Orange
+        line.Append(nick, PlainStyle(LogRgb(100, 200, 255), LogStyle::Bold));  // Light cyan/blue
+        line.Append("- " + text, PlainStyle(LogRgb(255, 180, 80)));
+        break;
+
+    case MessageKind::Action:
+        // Format: * nick action
+        line.Append("* ", PlainStyle(LogRgb(200, 120, 255), LogStyle::Italic));  // Purple
+        line.Append(nick + " ", PlainStyle(LogRgb(100, 200, 255), LogStyle::Bold));  // Light cyan/blue
+        line.Append(text, PlainStyle(LogRgb(200, 120, 255), LogStyle::Italic));
+        break;
+
+    case MessageKind::Topic:
+        line.Append(text, PlainStyle(LogRgb(80, 220, 220)));  // Bright cyan
+        break;
+
+    case MessageKind::Log:
+        line.Append(text, PlainStyle(LogDefaultForeground));
+        break;
     }
 
-    m_log->BeginBold();
-    m_log->BeginTextColour(wxColour(255, 100, 100));  // Light red
-    m_log->WriteText(message + "\n");
-    m_log->EndTextColour();
-    m_log->EndBold();
-    m_log->ShowPosition(m_log->GetLastPosition());
+    return line;
 }
 
-void LogPanel::AppendChatMessage(const wxString& nick, const wxString& message)
+void LogPanel::Rerender()
 {
-    // CRITICAL: Always append at the end, not at click position
-    m_log->SetInsertionPointEnd();
+    // Formatted bodies are only kept for messages never shown; the rest
+    // are parsed again from the store
+    m_log->Clear();
+    m_pendingFormatted.insert(m_pendingFormatted.begin(), m_store.Size() - m_pending, nullptr);
+    m_pending = m_store.Size();
+    m_pendingBytes = 0;
+    for (std::size_t i = 0; i < m_pending; ++i)
+        m_pendingBytes += PendingBytes(i);
+
+    if (m_active)
+        RenderPending();
+    else
+        m_log->SetBacklogBytes(m_pendingBytes);
+}
 
-    // Add timestamp if enabled
-    if (m_settings && m_settings->showTimestamps)
+void LogPanel::RenderPending()
+{
+    std::vector<LogLine> lines;
+    std::vector<std::size_t> messageBytes;
+    lines.reserve(m_pending);
+    messageBytes.reserve(m_pending);
+    const std::size_t first = m_store.Size() - m_pending;
+    for (std::size_t i = 0; i < m_pending; ++i)
     {
-        wxString format = m_settings->use24HourFormat ? "[%H:%M:%S] " : "[%I:%M:%S %p] ";
-        wxString timestamp = wxDateTime::Now().Format(format);
-        m_log->BeginTextColour(wxColour(128, 128, 128));  // Gray
-        m_log->WriteText(timestamp);
-        m_log->EndTextColour();
+        lines.push_back(RenderMessage(first + i, m_pendingFormatted[i].get()));
+        messageBytes.push_back(m_store.MessageBytes(first + i));
     }
+    m_pending = 0;
+    m_pendingBytes = 0;
+    m_pendingFormatted.clear();
+
+    // The backlog is charged again line by line
+    m_log->SetBacklogBytes(0);
+    m_log->AppendLines(std::move(lines), messageBytes);
+    SyncStoreWithView();
+}
 
-    // Format: <nick> message
-    m_log->WriteText("<");
-    m_log->BeginBold();
-    m_log->BeginTextColour(wxColour(100, 200, 255));  // Light cyan/blue
-    m_log->WriteText(nick);
-    m_log->EndTextColour();
-    m_log->EndBold();
-    m_log->WriteText("> ");
+void LogPanel::SetActive(bool active)
+{
+    if (active == m_active)
+        return;
+
+    m_active = active;
+    if (!active)
+        return;
 
-    // Message might contain IRC color codes
-    AppendIRCStyledText(message);
-    m_log->WriteText("\n");
-    m_log->ShowPosition(m_log->GetLastPosition());
+    m_unread = 0;
+    if (m_pending)
+        RenderPending();
 }
 
-void LogPanel::AppendNotice(const wxString& nick, const wxString& message)
+void LogPanel::AppendSystemMessage(const wxString& message)
 {
-    // CRITICAL: Always append at the end, not at click position
-    m_log->SetInsertionPointEnd();
+    AddMessage(MessageKind::System, wxEmptyString, message);
+}
 
-    // Add timestamp if enabled
-    if (m_settings && m_settings->showTimestamps)
-    {
-        wxString format = m_settings->use24HourFormat ? "[%H:%M:%S] " : "[%I:%M:%S %p] ";
-        wxString timestamp = wxDateTime::Now().Format(format);
-        m_log->BeginTextColour(wxColour(128, 128, 128));  // Gray
-        m_log->WriteText(timestamp);
-        m_log->EndTextColour();
-    }
+void LogPanel::AppendErrorMessage(const wxString& message)
+{
+    AddMessage(MessageKind::Error, wxEmptyString, message);
+}
 
-    // Format: -nick- message
-    m_log->BeginTextColour(wxColour(255, 180, 80));  // Orange
-    m_log->WriteText("-");
-    m_log->EndTextColour();
+void LogPanel::AppendChatMessage(const wxString& nick, const wxString& message)
+{
+    AddMessage(MessageKind::Chat, nick, message);
+}
 
-    m_log->BeginBold();
-    m_log->BeginTextColour(wxColour(100, 200, 255));  // Light cyan/blue
-    m_log->WriteText(nick);
-    m_log->EndTextColour();
-    m_log->EndBold();
+void LogPanel::AppendChatMessage(const wxString& nick, std::shared_ptr<const FormattedText> formatted)
+{
+    AddMessage(MessageKind::Chat, nick, wxEmptyString, std::move(formatted));
+}
 
-    m_log->BeginTextColour(wxColour(255, 180, 80));  // Orange
-    m_log->WriteText("- ");
-    m_log->WriteText(message + "\n");
-    m_log->EndTextColour();
-    m_log->ShowPosition(m_log->GetLastPosition());
+void LogPanel::AppendNotice(const wxString& nick, const wxString& message)
+{
+    AddMessage(MessageKind::Notice, nick, message);
 }
 
 void LogPanel::AppendAction(const wxString& nick, const wxString& action)
 {
-    // CRITICAL: Always append at the end, not at click position
-    m_log->SetInsertionPointEnd();
-
-    // Add timestamp if enabled
-    if (m_settings && m_settings->showTimestamps)
-    {
-        wxString format = m_settings->use24HourFormat ? "[%H:%M:%S] " : "[%I:%M:%S %p] ";
-        wxString timestamp = wxDateTime::Now().Format(format);
-        m_log->BeginTextColour(wxColour(128, 128, 128));  // Gray
-        m_log->WriteText(timestamp);
-        m_log->EndTextColour();
-    }
+    AddMessage(MessageKind::Action, nick, action);
+}
 
-    // Format: * nick action
-    m_log->BeginItalic();
-    m_log->BeginTextColour(wxColour(200, 120, 255));  // Purple
-    m_log->WriteText("* ");
-    m_log->EndTextColour();
-    m_log->EndItalic();
+void LogPanel::AppendTopicMessage(const wxString& message)
+{
+    AddMessage(MessageKind::Topic, wxEmptyString, message);
+}
 
-    m_log->BeginBold();
-    m_log->BeginTextColour(wxColour(100, 200, 255));  // Light cyan/blue
-    m_log->WriteText(nick + " ");
-    m_log->EndTextColour();
-    m_log->EndBold();
+void LogPanel::AppendLog(const wxString& text)
+{
+    AddMessage(MessageKind::Log, wxEmptyString, text);
+}
 
-    m_log->BeginItalic();
-    m_log->BeginTextColour(wxColour(200, 120, 255));  // Purple
-    m_log->WriteText(action + "\n");
-    m_log->EndTextColour();
-    m_log->EndItalic();
-    m_log->ShowPosition(m_log->GetLastPosition());
+void LogPanel::Clear()
+{
+    m_log->Clear();
+    m_store.Clear();
+    m_pending = 0;
+    m_pendingBytes = 0;
+    m_pendingFormatted.clear();
+    m_unread = 0;
+    m_log->SetBacklogBytes(0);
+    m_log->SetSharedBytes(0);
 }
 
-void LogPanel::AppendTopicMessage(const wxString& message)
+void LogPanel::SetSettings(const AppSettings* settings)
 {
-    // CRITICAL: Always append at the end, not at click position
-    m_log->SetInsertionPointEnd();
+    m_settings = settings;
+    ApplyScrollbackLimits();
 
-    // Add timestamp if enabled
-    if (m_settings && m_settings->showTimestamps)
+    // Timestamps are formatted at render time, so a format change can be
+    // applied to the lines already shown
+    bool showTimestamps = m_settings && m_settings->showTimestamps;
+    bool use24Hour = !m_settings || m_settings->use24HourFormat;
+    if (showTimestamps != m_renderTimestamps || use24Hour != m_render24Hour)
     {
-        wxString format = m_settings->use24HourFormat ? "[%H:%M:%S] " : "[%I:%M:%S %p] ";
-        wxString timestamp = wxDateTime::Now().Format(format);
-        m_log->BeginTextColour(wxColour(128, 128, 128));  // Gray
-        m_log->WriteText(timestamp);
-        m_log->EndTextColour();
+        m_renderTimestamps = showTimestamps;
+        m_render24Hour = use24Hour;
+        Rerender();
     }
+}
 
-    m_log->BeginTextColour(wxColour(80, 220, 220));  // Bright cyan
-    m_log->WriteText(message + "\n");
-    m_log->EndTextColour();
-    m_log->ShowPosition(m_log->GetLastPosition());
+std::size_t LogPanel::GetScrollbackBytes() const
+{
+    // The view charges each line with the stored message behind it, and
+    // the store's nick table as a whole
+    return m_log->GetMemoryUsage();
 }
 
-void LogPanel::AppendLog(const wxString& line)
+void LogPanel::ApplyScrollbackLimits()
 {
-    // CRITICAL: Always append at the end, not at click position
-    m_log->SetInsertionPointEnd();
+    if (!m_settings)
+        return;
 
-    // Add timestamp if enabled
-    if (m_settings && m_settings->showTimestamps)
-    {
-        wxString format = m_settings->use24HourFormat ? "[%H:%M:%S] " : "[%I:%M:%S %p] ";
-        wxString timestamp = wxDateTime::Now().Format(format);
-        m_log->BeginTextColour(wxColour(128, 128, 128));  // Gray
-        m_log->WriteText(timestamp);
-        m_log->EndTextColour();
-    }
+    m_log->SetScrollbackLimits(static_cast<std::size_t>(std::max(m_settings->scrollbackLines, 0)),
+                               static_cast<std::size_t>(std::max(m_settings->scrollbackKilobytes, 0)) * 1024);
+}
+
+// -------- NickListCtrl --------
 
-    m_log->WriteText(line + "\n");
-    m_log->ShowPosition(m_log->GetLastPosition());
+NickListCtrl::NickListCtrl(wxWindow* parent, const ChannelMembers& members)
+    : wxListCtrl(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+                 wxLC_REPORT | wxLC_VIRTUAL | wxLC_NO_HEADER | wxLC_SINGLE_SEL),
+      m_members(members)
+{
+    InsertColumn(0, wxEmptyString);
+
+    // The single column always spans the control
+    Bind(wxEVT_SIZE, [this](wxSizeEvent& evt) {
+        SetColumnWidth(0, GetClientSize().GetWidth());
+        evt.Skip();
+    });
 }
 
-void LogPanel::Clear()
+void NickListCtrl::Sync()
 {
-    m_log->Clear();
+    SetItemCount(static_cast<long>(m_members.Size()));
+    Refresh();
 }
 
-void LogPanel::SetSettings(const AppSettings* settings)
+wxString NickListCtrl::GetNick(long row) const
 {
-    m_settings = settings;
+    if (row < 0 || static_cast<std::size_t>(row) >= m_members.Size())
+        return wxEmptyString;
+
+    const std::string& nick = m_members.UserAt(static_cast<std::size_t>(row)).nick;
+    return wxString::FromUTF8(nick.data(), nick.size());
+}
+
+wxString NickListCtrl::OnGetItemText(long item, long) const
+{
+    if (item < 0 || static_cast<std::size_t>(item) >= m_members.Size())
+        return wxEmptyString;
+
+    auto row = static_cast<std::size_t>(item);
+    const std::string& nick = m_members.UserAt(row).nick;
+    wxString text = wxString::FromUTF8(nick.data(), nick.size());
+    if (char symbol = m_members.PrefixSymbol(m_members.ModesAt(row)))
+        text.Prepend(wxUniChar(symbol));
+    return text;
 }
 
 // -------- ChannelPage --------
 
-ChannelPage::ChannelPage(wxWindow* parent, const wxString& channelName, const AppSettings* settings, ServerConnectionPanel* serverPanel)
+ChannelPage::ChannelPage(wxWindow* parent, const wxString& channelName, UserRegistry& users,
+                         const AppSettings* settings, ServerConnectionPanel* serverPanel)
     : wxPanel(parent, wxID_ANY),
       m_channelName(channelName),
+      m_members(users, std::string(channelName.ToUTF8())),
       m_serverPanel(serverPanel)
 {
     m_log = new LogPanel(this, settings, serverPanel);
-    m_nickList = new wxListBox(this, wxID_ANY);
+    m_nickList = new NickListCtrl(this, m_members);
 
     // Use monospace font for nick list too
     wxFont font = m_nickList->GetFont();
     font.SetFamily(wxFONTFAMILY_TELETYPE);
     m_nickList->SetFont(font);
 
-    // Bind double-click event on nick list
-    m_nickList->Bind(wxEVT_LISTBOX_DCLICK, &ChannelPage::OnNickDoubleClick, this);
+    // Double-click (or Enter) on a nick
+    m_nickList->Bind(wxEVT_LIST_ITEM_ACTIVATED, &ChannelPage::OnNickActivated, this);
 
     auto* sizer = new wxBoxSizer(wxHORIZONTAL);
     sizer->Add(m_log, 3, wxEXPAND | wxALL, 2);
@@ -708,9 +460,31 @@ void ChannelPage::ClearLog()
     m_log->Clear();
 }
 
-wxListBox* ChannelPage::GetNickList()
+const MessageStore& ChannelPage::GetMessageStore() const
 {
-    return m_nickList;
+    return m_log->GetMessageStore();
+}
+
+void ChannelPage::SetActive(bool active)
+{
+    m_log->SetActive(active);
+}
+
+std::size_t ChannelPage::GetUnreadCount() const
+{
+    return m_log->GetUnreadCount();
+}
+
+void ChannelPage::MembersChanged()
+{
+    if (m_nickListPending)
+        return;
+
+    m_nickListPending = true;
+    CallAfter([this]() {
+        m_nickListPending = false;
+        m_nickList->Sync();
+    });
 }
 
 const wxString& ChannelPage::GetChannelName() const
@@ -724,12 +498,23 @@ void ChannelPage::SetSettings(const AppSettings* settings)
         m_log->SetSettings(settings);
 }
 
+std::size_t ChannelPage::GetScrollbackBytes() const
+{
+    return m_log ? m_log->GetScrollbackBytes() : 0;
+}
+
 void ChannelPage::AppendChatMessage(const wxString& nick, const wxString& message)
 {
     if (m_log)
         m_log->AppendChatMessage(nick, message);
 }
 
+void ChannelPage::AppendChatMessage(const wxString& nick, std::shared_ptr<const FormattedText> formatted)
+{
+    if (m_log)
+        m_log->AppendChatMessage(nick, std::move(formatted));
+}
+
 void ChannelPage::AppendNotice(const wxString& nick, const wxString& message)
 {
     if (m_log)
@@ -754,18 +539,10 @@ void ChannelPage::AppendErrorMessage(const wxString& message)
         m_log->AppendErrorMessage(message);
 }
 
-void ChannelPage::OnNickDoubleClick(wxCommandEvent& evt)
+void ChannelPage::OnNickActivated(wxListEvent& evt)
 {
-    int selection = m_nickList->GetSelection();
-    if (selection == wxNOT_FOUND)
-        return;
-
-    wxString nick = m_nickList->GetString(selection);
-
-    // Remove channel prefix symbols (@, +, %, ~, etc.)
-    while (!nick.IsEmpty() && !wxIsalnum(nick[0]) && nick[0] != '[' && nick[0] != '{' && nick[0] != '_')
-        nick = nick.Mid(1);
-
+    // Rows hold bare nicks; the prefix symbol is only drawn
+    wxString nick = m_nickList->GetNick(evt.GetIndex());
     if (nick.IsEmpty())
         return;
 
@@ -1,10 +1,15 @@
 #pragma once
 
 #include <wx/panel.h>
-#include <wx/richtext/richtextctrl.h>
-#include <wx/listbox.h>
+#include <wx/listctrl.h>
 #include <wx/sizer.h>
 #include <wx/string.h>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "ChannelMembers.h"
+#include "LogView.h"
+#include "MessageStore.h"
 
 // Forward declare - only need pointer
 struct AppSettings;
@@ -28,57 +33,115 @@ public:
     void AppendAction(const wxString& nick, const wxString& action);
     void AppendTopicMessage(const wxString& message);
 
-    // IRC color code parsing
-    void AppendIRCStyledText(const wxString& text);
+    // Chat message whose body was already formatted off the GUI thread;
+    // kept until rendered if the tab is hidden
+    void AppendChatMessage(const wxString& nick, std::shared_ptr<const FormattedText> formatted);
+
+    // Approximate memory held by the scrollback
+    std::size_t GetScrollbackBytes() const;
+
+    // The messages shown, oldest first
+    const MessageStore& GetMessageStore() const { return m_store; }
+
+    // While inactive (its tab not selected), messages are only recorded;
+    // activating renders everything that arrived meanwhile in one batch
+    void SetActive(bool active);
+    bool IsActive() const { return m_active; }
+
+    // Messages from other people that arrived while inactive
+    std::size_t GetUnreadCount() const { return m_unread; }
 
 private:
-    // IRC color code helpers
-    wxColour GetIRCColor(int colorCode);
-    struct IRCTextSegment
-    {
-        wxString text;
-        wxColour foreground;
-        wxColour background;
-        bool bold = false;
-        bool italic = false;
-        bool underline = false;
-        bool useDefaultFg = true;
-        bool useDefaultBg = true;
-    };
-    void ParseIRCColors(const wxString& input, std::vector<IRCTextSegment>& segments);
-
-    wxRichTextCtrl* m_log = nullptr;
+    void ApplyScrollbackLimits();
+
+    // Record a message, then render it into the view
+    void AddMessage(MessageKind kind, const wxString& nick, const wxString& text,
+                    std::shared_ptr<const FormattedText> formatted = nullptr);
+    void SyncStoreWithView();
+    std::size_t PendingBytes(std::size_t pendingIndex) const;
+    std::size_t DropPending(std::size_t count);
+    std::size_t TrimBacklog(std::size_t bytes);
+    LogLine RenderMessage(std::size_t index, const FormattedText* formatted = nullptr) const;
+    void Rerender();
+    void RenderPending();
+
+    LogStyle PlainStyle(std::uint32_t colour, std::uint8_t flags = 0) const;
+
+    LogView* m_log = nullptr;
+    MessageStore m_store;
     const AppSettings* m_settings = nullptr;
     ServerConnectionPanel* m_serverPanel = nullptr;
-    wxColour m_defaultForeground;
-    wxColour m_defaultBackground;
-    wxStockCursor m_currentCursor = wxCURSOR_ARROW;
+
+    // Timestamp format the view was rendered with
+    bool m_renderTimestamps = false;
+    bool m_render24Hour = true;
+
+    // Deferred rendering: the newest m_pending messages of the store are
+    // not in the view yet; the view charges their bytes as its backlog
+    bool m_active = true;
+    std::size_t m_pending = 0;
+    std::size_t m_pendingBytes = 0;
+    std::deque<std::shared_ptr<const FormattedText>> m_pendingFormatted;  // one per pending message
+    std::size_t m_unread = 0;
+};
+
+// Nick list over a channel's members. Virtual: only the rows on screen are
+// asked for their text, so a 20k-user channel costs what a small one does.
+class NickListCtrl : public wxListCtrl
+{
+public:
+    NickListCtrl(wxWindow* parent, const ChannelMembers& members);
+
+    // Pick up changes to the members
+    void Sync();
+
+    wxString GetNick(long row) const;
+
+protected:
+    wxString OnGetItemText(long item, long column) const override;
+
+private:
+    const ChannelMembers& m_members;
 };
 
 // A single channel tab: log on left, nick list on right
 class ChannelPage : public wxPanel
 {
 public:
-    ChannelPage(wxWindow* parent, const wxString& channelName, const AppSettings* settings = nullptr, ServerConnectionPanel* serverPanel = nullptr);
+    ChannelPage(wxWindow* parent, const wxString& channelName, UserRegistry& users,
+                const AppSettings* settings = nullptr, ServerConnectionPanel* serverPanel = nullptr);
 
     void AppendLog(const wxString& line);
     void ClearLog();
-    wxListBox* GetNickList();
+
+    // Membership (over the connection's users); call MembersChanged()
+    // after editing so the nick list catches up, once per event loop pass
+    // however many edits
+    ChannelMembers& GetMembers() { return m_members; }
+    const ChannelMembers& GetMembers() const { return m_members; }
+    void MembersChanged();
     const wxString& GetChannelName() const;
     void SetSettings(const AppSettings* settings);
+    std::size_t GetScrollbackBytes() const;
+    const MessageStore& GetMessageStore() const;
+    void SetActive(bool active);
+    std::size_t GetUnreadCount() const;
 
     // Forward to LogPanel's specialized methods
     void AppendChatMessage(const wxString& nick, const wxString& message);
+    void AppendChatMessage(const wxString& nick, std::shared_ptr<const FormattedText> formatted);
     void AppendNotice(const wxString& nick, const wxString& message);
     void AppendAction(const wxString& nick, const wxString& action);
     void AppendSystemMessage(const wxString& message);
     void AppendErrorMessage(const wxString& message);
 
 private:
-    void OnNickDoubleClick(wxCommandEvent& evt);
+    void OnNickActivated(wxListEvent& evt);
 
     wxString m_channelName;
     LogPanel* m_log = nullptr;
-    wxListBox* m_nickList = nullptr;
+    ChannelMembers m_members;
+    NickListCtrl* m_nickList = nullptr;
+    bool m_nickListPending = false;
     ServerConnectionPanel* m_serverPanel = nullptr;
 };
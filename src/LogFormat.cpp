@@ -0,0 +1,551 @@
+#include "LogFormat.h"
+
+#include <wx/datetime.h>
+
+#include <algorithm>
+#include <cstring>
+
+// ASTRA_LOG_SCALAR forces the portable scan, for comparing against it
+#if defined(__AVX2__) && !defined(ASTRA_LOG_SCALAR)
+#define ASTRA_LOG_AVX2
+#endif
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(ASTRA_LOG_SCALAR)
+#define ASTRA_LOG_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(ASTRA_LOG_AVX2)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+void LogLine::Append(const wxString& run, const LogStyle& style)
+{
+    if (run.IsEmpty())
+        return;
+
+    std::uint32_t start = static_cast<std::uint32_t>(text.length());
+    std::uint32_t length = static_cast<std::uint32_t>(run.length());
+    text += run;
+
+    if (!spans.empty() && spans.back().style == style && spans.back().start + spans.back().length == start)
+        spans.back().length += length;
+    else
+        spans.push_back(LogSpan{ start, length, style });
+}
+
+void LogLine::Append(const LogLine& other)
+{
+    std::uint32_t offset = static_cast<std::uint32_t>(text.length());
+    text += other.text;
+
+    for (LogSpan span : other.spans)
+    {
+        span.start += offset;
+        if (!spans.empty() && spans.back().style == span.style && spans.back().start + spans.back().length == span.start)
+            spans.back().length += span.length;
+        else
+            spans.push_back(span);
+    }
+
+    for (LogUrl url : other.urls)
+    {
+        url.start += offset;
+        urls.push_back(url);
+    }
+}
+
+const LogUrl* LogLine::UrlAt(std::size_t offset) const
+{
+    auto it = std::upper_bound(urls.begin(), urls.end(), offset,
+                               [](std::size_t value, const LogUrl& url) { return value < url.start; });
+    if (it == urls.begin())
+        return nullptr;
+
+    --it;
+    return offset < it->start + it->length ? &*it : nullptr;
+}
+
+// mIRC standard colours, at palette indices 0-15
+static const std::uint32_t IRC_COLORS[] = {
+    LogRgb(255, 255, 255),    // 0  - White
+    LogRgb(0,   0,   0),      // 1  - Black
+    LogRgb(0,   0,   127),    // 2  - Blue
+    LogRgb(0,   147, 0),      // 3  - Green
+    LogRgb(255, 0,   0),      // 4  - Red
+    LogRgb(127, 0,   0),      // 5  - Brown/Maroon
+    LogRgb(156, 0,   156),    // 6  - Purple
+    LogRgb(252, 127, 0),      // 7  - Orange
+    LogRgb(255, 255, 0),      // 8  - Yellow
+    LogRgb(0,   252, 0),      // 9  - Light Green
+    LogRgb(0,   147, 147),    // 10 - Cyan
+    LogRgb(0,   255, 255),    // 11 - Light Cyan
+    LogRgb(0,   0,   252),    // 12 - Light Blue
+    LogRgb(255, 0,   255),    // 13 - Pink/Magenta
+    LogRgb(127, 127, 127),    // 14 - Gray
+    LogRgb(210, 210, 210)     // 15 - Light Gray
+};
+
+static std::size_t HashColour(std::uint32_t rgb)
+{
+    return (rgb * 2654435761u) >> 19;  // top 13 bits
+}
+static_assert(LogPalette::Capacity * 2 == 1 << 13, "HashColour yields a table index");
+
+LogPalette& LogPalette::Instance()
+{
+    static LogPalette palette;
+    return palette;
+}
+
+LogPalette::LogPalette()
+{
+    // All distinct, so each lands on its fixed index
+    for (std::uint32_t rgb : IRC_COLORS)
+        Insert(rgb);
+    Insert(LogDefaultForeground);
+    Insert(LogDefaultBackground);
+}
+
+std::uint16_t LogPalette::Index(std::uint32_t rgb)
+{
+    for (std::size_t i = HashColour(rgb);; i = (i + 1) % TableSize)
+    {
+        std::uint64_t entry = m_table[i].load(std::memory_order_acquire);
+        if (entry == 0)
+            break;
+        if (static_cast<std::uint32_t>(entry) == rgb)
+            return static_cast<std::uint16_t>((entry >> 32) - 1);
+    }
+
+    std::lock_guard<std::mutex> lock(m_insertMutex);
+    return Insert(rgb);
+}
+
+std::uint16_t LogPalette::Insert(std::uint32_t rgb)
+{
+    // Another thread may have added it between our probe and the lock. The
+    // table is never more than half full, so probing always ends.
+    std::size_t i = HashColour(rgb);
+    for (;; i = (i + 1) % TableSize)
+    {
+        std::uint64_t entry = m_table[i].load(std::memory_order_relaxed);
+        if (entry == 0)
+            break;
+        if (static_cast<std::uint32_t>(entry) == rgb)
+            return static_cast<std::uint16_t>((entry >> 32) - 1);
+    }
+
+    if (m_count == Capacity)
+        return DefaultForeground;
+
+    auto index = static_cast<std::uint16_t>(m_count++);
+    m_colours[index].store(rgb, std::memory_order_release);
+    m_table[i].store((std::uint64_t{ index } + 1) << 32 | rgb, std::memory_order_release);
+    return index;
+}
+
+// Formatting control codes
+enum : unsigned char
+{
+    CodeBold = 0x02,
+    CodeColour = 0x03,           // \x03[fg[,bg]], mIRC colour numbers
+    CodeHexColour = 0x04,        // \x04[RRGGBB[,RRGGBB]]
+    CodeReset = 0x0F,
+    CodeMonospace = 0x11,
+    CodeReverse = 0x16,
+    CodeItalic = 0x1D,
+    CodeStrikethrough = 0x1E,
+    CodeUnderline = 0x1F
+};
+
+static constexpr std::uint32_t FormatCodeMask =
+    1u << CodeBold | 1u << CodeColour | 1u << CodeHexColour | 1u << CodeReset | 1u << CodeMonospace |
+    1u << CodeReverse | 1u << CodeItalic | 1u << CodeStrikethrough | 1u << CodeUnderline;
+
+static bool IsFormatCode(unsigned char c)
+{
+    return c < 32 && (FormatCodeMask >> c) & 1;
+}
+
+#if defined(ASTRA_LOG_SSE2) || defined(ASTRA_LOG_AVX2)
+static unsigned LowestBit(std::uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+// Offset of the first formatting code at or after `from`, or text.size().
+// Control bytes are rare, so a block is first checked for any byte below
+// 0x20 (UTF-8 multibyte sequences never contain one) and only the hits are
+// looked at one by one.
+static std::size_t FindFormatCode(std::string_view text, std::size_t from)
+{
+    const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+    std::size_t n = text.size();
+    std::size_t i = from;
+
+#if defined(ASTRA_LOG_AVX2)
+    const __m256i limit = _mm256_set1_epi8(0x1F);
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v, limit), v)));
+        for (; mask; mask &= mask - 1)
+        {
+            std::size_t at = i + LowestBit(mask);
+            if (IsFormatCode(p[at]))
+                return at;
+        }
+    }
+#endif
+#if defined(ASTRA_LOG_SSE2)
+    const __m128i limit16 = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, limit16), v)));
+        for (; mask; mask &= mask - 1)
+        {
+            std::size_t at = i + LowestBit(mask);
+            if (IsFormatCode(p[at]))
+                return at;
+        }
+    }
+#else
+    // Eight bytes at a time: the high bit of each byte below 0x20 is set
+    constexpr std::uint64_t ones = 0x0101010101010101ull;
+    constexpr std::uint64_t highs = 0x8080808080808080ull;
+    for (; i + 8 <= n; i += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if (((word - ones * 0x20) & ~word & highs) == 0)
+            continue;
+        for (std::size_t at = i; at < i + 8; ++at)
+        {
+            if (IsFormatCode(p[at]))
+                return at;
+        }
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        if (IsFormatCode(p[i]))
+            return i;
+    }
+    return n;
+}
+
+// Formatting in effect while walking a line
+struct IrcFormatState
+{
+    std::uint16_t foreground = LogPalette::DefaultForeground;
+    std::uint16_t background = LogPalette::DefaultBackground;
+    bool hasForeground = false;
+    bool hasBackground = false;
+    bool bold = false;
+    bool italic = false;
+    bool underline = false;
+    bool strikethrough = false;
+    bool reverse = false;
+
+    LogStyle Style() const
+    {
+        std::uint8_t flags = 0;
+        if (bold)
+            flags |= LogStyle::Bold;
+        if (italic)
+            flags |= LogStyle::Italic;
+        if (underline)
+            flags |= LogStyle::Underline;
+        if (strikethrough)
+            flags |= LogStyle::Strikethrough;
+
+        std::uint16_t fg = hasForeground ? foreground : std::uint16_t{ LogPalette::DefaultForeground };
+        if (reverse)
+        {
+            // Reverse swaps whatever colours are showing
+            std::uint16_t bg = hasBackground ? background : std::uint16_t{ LogPalette::DefaultBackground };
+            return LogStyle::Make(bg, flags | LogStyle::HasBackground, fg);
+        }
+        if (hasBackground)
+            return LogStyle::Make(fg, flags | LogStyle::HasBackground, background);
+        return LogStyle::Make(fg, flags);
+    }
+};
+
+// mIRC colour number of one or two digits at `pos`; -1 if there is none
+static int ParseColourNumber(std::string_view text, std::size_t& pos)
+{
+    int value = -1;
+    for (int digits = 0; digits < 2 && pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++digits)
+        value = (value < 0 ? 0 : value * 10) + (text[pos++] - '0');
+    return value;
+}
+
+// RRGGBB at `pos`; false (and nothing consumed) if there is none
+static bool ParseHexColour(std::string_view text, std::size_t& pos, std::uint32_t& rgb)
+{
+    if (text.size() - pos < 6)
+        return false;
+
+    std::uint32_t value = 0;
+    for (std::size_t i = pos; i < pos + 6; ++i)
+    {
+        char c = text[i];
+        unsigned digit;
+        if (c >= '0' && c <= '9')
+            digit = static_cast<unsigned>(c - '0');
+        else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            digit = static_cast<unsigned>((c | 0x20) - 'a' + 10);
+        else
+            return false;
+        value = value << 4 | digit;
+    }
+
+    pos += 6;
+    rgb = value;
+    return true;
+}
+
+// Apply the code at `pos`, returning where the text after it (and its
+// arguments) starts
+static std::size_t ApplyFormatCode(IrcFormatState& state, std::string_view text, std::size_t pos)
+{
+    unsigned char code = static_cast<unsigned char>(text[pos++]);
+    switch (code)
+    {
+    case CodeBold:
+        state.bold = !state.bold;
+        break;
+
+    case CodeItalic:
+        state.italic = !state.italic;
+        break;
+
+    case CodeUnderline:
+        state.underline = !state.underline;
+        break;
+
+    case CodeStrikethrough:
+        state.strikethrough = !state.strikethrough;
+        break;
+
+    case CodeReverse:
+        state.reverse = !state.reverse;
+        break;
+
+    case CodeMonospace:
+        // The log is drawn in a monospace font already
+        break;
+
+    case CodeReset:
+        state = IrcFormatState();
+        break;
+
+    case CodeColour:
+    {
+        int fg = ParseColourNumber(text, pos);
+        if (fg < 0)
+        {
+            // \x03 alone resets colors
+            state.hasForeground = false;
+            state.hasBackground = false;
+            break;
+        }
+
+        // 0-15 are the palette; anything else (99 included) is the default
+        state.foreground = static_cast<std::uint16_t>(fg);
+        state.hasForeground = fg < 16;
+
+        // A comma only belongs to the code when a number follows
+        if (pos + 1 < text.size() && text[pos] == ',' && text[pos + 1] >= '0' && text[pos + 1] <= '9')
+        {
+            ++pos;
+            int bg = ParseColourNumber(text, pos);
+            state.background = static_cast<std::uint16_t>(bg);
+            state.hasBackground = bg < 16;
+        }
+        break;
+    }
+
+    case CodeHexColour:
+    {
+        std::uint32_t rgb;
+        if (!ParseHexColour(text, pos, rgb))
+        {
+            state.hasForeground = false;
+            state.hasBackground = false;
+            break;
+        }
+
+        LogPalette& palette = LogPalette::Instance();
+        state.foreground = palette.Index(rgb);
+        state.hasForeground = true;
+
+        std::size_t bgPos = pos + 1;
+        if (pos < text.size() && text[pos] == ',' && ParseHexColour(text, bgPos, rgb))
+        {
+            pos = bgPos;
+            state.background = palette.Index(rgb);
+            state.hasBackground = true;
+        }
+        break;
+    }
+    }
+    return pos;
+}
+
+// Length of the URL prefix starting at `it`, or 0
+static std::size_t UrlPrefixAt(wxString::const_iterator it, wxString::const_iterator end)
+{
+    static const char* const prefixes[] = { "http://", "https://", "ftp://", "www." };
+    for (const char* prefix : prefixes)
+    {
+        std::size_t length = 0;
+        for (auto p = it; prefix[length] && p != end && *p == prefix[length]; ++p)
+            ++length;
+        if (!prefix[length])
+            return length;
+    }
+    return 0;
+}
+
+static bool EndsUrl(wxUniChar c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Trailing punctuation stays in the text, just outside the link
+static bool TrimmedFromUrl(wxUniChar c)
+{
+    return c == ',' || c == ')' || c == ']' || c == '}';
+}
+
+// Index of the span starting exactly at `offset`, splitting the one that
+// covers it if needed
+static std::size_t SplitSpanAt(std::vector<LogSpan>& spans, std::uint32_t offset)
+{
+    auto it = std::upper_bound(spans.begin(), spans.end(), offset,
+                               [](std::uint32_t value, const LogSpan& span) { return value < span.start; });
+    std::size_t index = static_cast<std::size_t>(it - spans.begin());
+    if (index == 0)
+        return 0;
+
+    LogSpan& covering = spans[index - 1];
+    if (covering.start == offset)
+        return index - 1;
+    if (offset >= covering.start + covering.length)
+        return index;
+
+    LogSpan tail{ offset, covering.start + covering.length - offset, covering.style };
+    covering.length = offset - covering.start;
+    spans.insert(spans.begin() + static_cast<std::ptrdiff_t>(index), tail);
+    return index;
+}
+
+// Record a link and draw the text under it as one (keeping bold)
+static void MarkUrl(LogLine& line, std::uint32_t start, std::uint32_t length)
+{
+    static const std::uint16_t urlColour = LogPalette::Instance().Index(LogRgb(80, 160, 255));
+
+    std::size_t first = SplitSpanAt(line.spans, start);
+    std::size_t last = SplitSpanAt(line.spans, start + length);
+    for (std::size_t i = first; i < last; ++i)
+    {
+        LogStyle& style = line.spans[i].style;
+        style = LogStyle::Make(urlColour, LogStyle::Underline | LogStyle::Url | (style.Flags() & LogStyle::Bold));
+    }
+    line.urls.push_back(LogUrl{ start, length });
+}
+
+// Find the links in the text from `from` on, in one pass. A link may cross
+// formatting codes; it ends at whitespace.
+static void MarkUrls(LogLine& line, std::size_t from)
+{
+    const wxString& text = line.text;
+    auto end = text.end();
+    std::size_t pos = from;
+    for (auto it = text.begin() + static_cast<std::ptrdiff_t>(from); it != end;)
+    {
+        wxUniChar c = *it;
+        std::size_t prefix = (c == 'h' || c == 'f' || c == 'w') ? UrlPrefixAt(it, end) : 0;
+        if (!prefix)
+        {
+            ++it;
+            ++pos;
+            continue;
+        }
+
+        std::size_t start = pos;
+        std::size_t urlEnd = pos;  // past the last character kept in the link
+        while (it != end && !EndsUrl(*it))
+        {
+            if (!TrimmedFromUrl(*it))
+                urlEnd = pos + 1;
+            ++it;
+            ++pos;
+        }
+
+        // A bare scheme with nothing after it is not a link
+        if (urlEnd - start > prefix)
+            MarkUrl(line, static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(urlEnd - start));
+    }
+}
+
+// Append a run of UTF-8 text in one style
+static void AppendStyledRun(LogLine& line, std::string_view utf8, const LogStyle& style)
+{
+    line.Append(wxString::FromUTF8(utf8.data(), utf8.size()), style);
+}
+
+// Append text with IRC formatting codes applied and URLs styled
+void AppendIrcFormattedText(LogLine& line, std::string_view text)
+{
+    std::size_t from = line.text.length();
+
+    // Most messages carry no formatting at all: one run, one conversion
+    std::size_t code = FindFormatCode(text, 0);
+    if (code == text.size())
+    {
+        AppendStyledRun(line, text, LogStyle());
+        MarkUrls(line, from);
+        return;
+    }
+
+    IrcFormatState state;
+    std::size_t pos = 0;
+    while (true)
+    {
+        if (code > pos)
+            AppendStyledRun(line, text.substr(pos, code - pos), state.Style());
+        if (code == text.size())
+            break;
+
+        pos = ApplyFormatCode(state, text, code);
+        code = FindFormatCode(text, pos);
+    }
+
+    MarkUrls(line, from);
+}
+
+const wxString& TimestampFormatter::Format(std::int64_t time, bool use24Hour)
+{
+    if (time != m_time || use24Hour != m_use24Hour)
+    {
+        wxString format = use24Hour ? "[%H:%M:%S] " : "[%I:%M:%S %p] ";
+        m_text = wxDateTime(static_cast<time_t>(time)).Format(format);
+        m_time = time;
+        m_use24Hour = use24Hour;
+    }
+    return m_text;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <wx/string.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Colours in the log model are packed 0xRRGGBB, not wxColour (which is a
+// reference-counted object several times the size)
+constexpr std::uint32_t LogRgb(unsigned r, unsigned g, unsigned b)
+{
+    return (r << 16) | (g << 8) | b;
+}
+
+// -------------------------------------------------------
+// LogPalette
+// Every colour a log line can use, by 12-bit index, so a whole style fits
+// in one 32-bit word. The mIRC colours sit at their own codes and the log
+// defaults right after them; any other colour gets the next free index on
+// first use and keeps it for the life of the process. Lookups are lock-free
+// from any thread; only adding a colour takes a lock.
+// -------------------------------------------------------
+
+class LogPalette
+{
+public:
+    static constexpr std::size_t Capacity = 4096;
+
+    // Fixed entries (0-15 are the mIRC colours)
+    enum Slot : std::uint16_t
+    {
+        DefaultForeground = 16,
+        DefaultBackground = 17
+    };
+
+    static LogPalette& Instance();
+
+    // Index of a colour, adding it if needed. A full palette maps new
+    // colours to the default foreground.
+    std::uint16_t Index(std::uint32_t rgb);
+
+    std::uint32_t Colour(std::uint16_t index) const
+    {
+        return m_colours[index].load(std::memory_order_acquire);
+    }
+
+private:
+    LogPalette();
+    std::uint16_t Insert(std::uint32_t rgb);
+
+    // Open-addressed rgb -> index map; a slot holds (index + 1) << 32 | rgb
+    static constexpr std::size_t TableSize = Capacity * 2;
+
+    std::array<std::atomic<std::uint32_t>, Capacity> m_colours{};
+    std::array<std::atomic<std::uint64_t>, TableSize> m_table{};
+    std::size_t m_count = 0;  // guarded by m_insertMutex
+    std::mutex m_insertMutex;
+};
+
+// How a run of text is drawn, packed into one word: flags in bits 0-7,
+// foreground palette index in bits 8-19, background in bits 20-31. Runs
+// compare and merge with a single integer compare.
+struct LogStyle
+{
+    enum Flags : std::uint8_t
+    {
+        Bold = 1 << 0,
+        Italic = 1 << 1,
+        Underline = 1 << 2,
+        HasBackground = 1 << 3,
+        Url = 1 << 4,
+        Strikethrough = 1 << 5
+    };
+
+    std::uint32_t word = std::uint32_t{ LogPalette::DefaultForeground } << 8;
+
+    // From palette indices
+    static LogStyle Make(std::uint16_t foreground, std::uint8_t flags = 0, std::uint16_t background = 0)
+    {
+        LogStyle style;
+        style.word = flags | (std::uint32_t{ foreground } << 8) | (std::uint32_t{ background } << 20);
+        return style;
+    }
+
+    // From a colour, looked up in the palette
+    static LogStyle FromRgb(std::uint32_t foreground, std::uint8_t flags = 0)
+    {
+        return Make(LogPalette::Instance().Index(foreground), flags);
+    }
+
+    std::uint8_t Flags() const { return static_cast<std::uint8_t>(word & 0xFF); }
+    std::uint16_t Foreground() const { return static_cast<std::uint16_t>((word >> 8) & 0xFFF); }
+    std::uint16_t Background() const { return static_cast<std::uint16_t>(word >> 20); }
+
+    void AddFlags(std::uint8_t flags) { word |= flags; }
+
+    bool operator==(const LogStyle& other) const { return word == other.word; }
+};
+
+struct LogSpan
+{
+    std::uint32_t start = 0;  // offset into LogLine::text
+    std::uint32_t length = 0;
+    LogStyle style;
+};
+static_assert(sizeof(LogSpan) == 12, "spans are kept per run of every line");
+
+// A link inside a line's text
+struct LogUrl
+{
+    std::uint32_t start = 0;  // offset into LogLine::text
+    std::uint32_t length = 0;
+};
+
+// One log line: the visible text (formatting codes already removed), the
+// styled runs covering it, and the links found in it when it was built
+struct LogLine
+{
+    wxString text;
+    std::vector<LogSpan> spans;
+    std::vector<LogUrl> urls;  // sorted, non-overlapping
+
+    // Append a run, merging it into the previous one if the style matches
+    void Append(const wxString& run, const LogStyle& style);
+
+    // Append another line's text, runs and links
+    void Append(const LogLine& other);
+
+    // Link covering `offset`, if any (binary search)
+    const LogUrl* UrlAt(std::size_t offset) const;
+};
+
+// Colours of the log window
+constexpr std::uint32_t LogDefaultForeground = LogRgb(220, 220, 220);
+constexpr std::uint32_t LogDefaultBackground = LogRgb(30, 30, 30);
+
+// Append UTF-8 message text with its formatting codes applied (mIRC and
+// hex colours, bold, italic, underline, strikethrough, reverse, monospace,
+// reset) and URLs marked as links. Touches nothing but `line`, so it can
+// run on any thread.
+void AppendIrcFormattedText(LogLine& line, std::string_view text);
+
+// A message body formatted ahead of time on the network thread, so the GUI
+// only has to copy its runs into the view
+struct FormattedText
+{
+    std::int64_t time = 0;  // when received, seconds since the epoch
+    std::string text;       // as received: UTF-8, formatting codes included
+    LogLine body;           // text as displayed
+    bool highlight = false; // text mentions our nick
+};
+
+// Timestamp prefix for log lines. Messages arrive in bursts within the same
+// second, so the formatted text is reused until the second changes.
+class TimestampFormatter
+{
+public:
+    const wxString& Format(std::int64_t time, bool use24Hour);
+
+private:
+    std::int64_t m_time = -1;
+    bool m_use24Hour = true;
+    wxString m_text;
+};
@@ -0,0 +1,766 @@
+#include "LogView.h"
+
+#include <wx/clipboard.h>
+#include <wx/dataobj.h>
+#include <wx/dcbuffer.h>
+#include <wx/dcclient.h>
+#include <wx/utils.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+
+// Gap between the window edge and the text
+static constexpr wxCoord Margin = 4;
+
+static const std::uint32_t SelectionBackground = LogRgb(60, 90, 140);
+
+static wxColour ToColour(std::uint32_t rgb)
+{
+    return wxColour((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF);
+}
+
+// Left edge of the character at `offset`, from the start of the line
+static wxCoord EdgeBefore(const std::vector<wxCoord>& extents, std::size_t offset)
+{
+    return offset ? extents[offset - 1] : 0;
+}
+
+// Second half of a surrogate pair; only UTF-16 strings (Windows) split a
+// character in two, and nothing may land between the halves
+static bool IsTrailingSurrogate(const wxString& text, std::size_t offset)
+{
+    if (offset >= text.length())
+        return false;
+    auto c = static_cast<std::uint32_t>(text[offset].GetValue());
+    return c >= 0xDC00 && c <= 0xDFFF;
+}
+
+// Fonts and colours shared by every view (GUI thread only). The fonts only
+// differ in the Bold/Italic/Underline/Strikethrough bits, so all are built together
+// on first use; a palette colour becomes a wxColour the first time it is
+// drawn and stays cached, as palette entries never change.
+// Bold, Italic and Underline are bits 0-2 of the style flags already
+static std::size_t FontIndex(std::uint8_t flags)
+{
+    return (flags & (LogStyle::Bold | LogStyle::Italic | LogStyle::Underline)) |
+           (flags & LogStyle::Strikethrough ? 8 : 0);
+}
+
+struct LogStyleCache
+{
+    std::array<wxFont, 16> fonts;  // by FontIndex()
+    std::vector<wxColour> colours = std::vector<wxColour>(LogPalette::Capacity);
+
+    LogStyleCache()
+    {
+        wxFont base(10, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
+        for (std::size_t i = 0; i < fonts.size(); ++i)
+        {
+            wxFont font = base;
+            if (i & LogStyle::Bold)
+                font.SetWeight(wxFONTWEIGHT_BOLD);
+            if (i & LogStyle::Italic)
+                font.SetStyle(wxFONTSTYLE_ITALIC);
+            if (i & LogStyle::Underline)
+                font.SetUnderlined(true);
+            if (i & 8)
+                font.SetStrikethrough(true);
+            fonts[i] = font;
+        }
+    }
+};
+
+static LogStyleCache& Styles()
+{
+    static LogStyleCache styles;
+    return styles;
+}
+
+static const wxFont& FontFor(std::uint8_t flags)
+{
+    return Styles().fonts[FontIndex(flags)];
+}
+
+static const wxColour& ColourFor(std::uint16_t index)
+{
+    wxColour& colour = Styles().colours[index];
+    if (!colour.IsOk())
+        colour = ToColour(LogPalette::Instance().Colour(index));
+    return colour;
+}
+
+// Every live view, for the shared memory budget (GUI thread only)
+struct ScrollbackBudget
+{
+    std::vector<LogView*> views;
+    std::size_t totalBytes = 0;
+    std::size_t limit = 0;  // 0 = unlimited
+};
+
+static ScrollbackBudget& Budget()
+{
+    static ScrollbackBudget budget;
+    return budget;
+}
+
+// -------- LogView --------
+
+LogView::LogView(wxWindow* parent, wxWindowID id)
+    : wxVScrolledWindow(parent, id, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE)
+{
+    // Every pixel is painted in OnPaint
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+    SetBackgroundColour(ToColour(m_defaultBackground));
+    SetFont(FontFor(0));
+    UpdateMetrics();
+
+    Bind(wxEVT_PAINT, &LogView::OnPaint, this);
+    Bind(wxEVT_SIZE, &LogView::OnSize, this);
+    Bind(wxEVT_LEFT_DOWN, &LogView::OnMouseDown, this);
+    Bind(wxEVT_MOTION, &LogView::OnMouseMove, this);
+    Bind(wxEVT_LEFT_UP, &LogView::OnMouseUp, this);
+    Bind(wxEVT_LEAVE_WINDOW, [this](wxMouseEvent& evt) {
+        if (m_handCursor)
+        {
+            m_handCursor = false;
+            SetCursor(wxCursor(wxCURSOR_ARROW));
+        }
+        evt.Skip();
+    });
+
+    Budget().views.push_back(this);
+}
+
+LogView::~LogView()
+{
+    ScrollbackBudget& budget = Budget();
+    budget.views.erase(std::find(budget.views.begin(), budget.views.end(), this));
+    budget.totalBytes -= m_bytes;
+}
+
+void LogView::AppendLine(LogLine line, std::size_t backingBytes)
+{
+    StoreLine(std::move(line), backingBytes);
+    FinishAppend();
+}
+
+void LogView::AppendLines(std::vector<LogLine> lines, const std::vector<std::size_t>& backingBytes)
+{
+    // One trim, layout and scroll for the whole batch
+    for (std::size_t i = 0; i < lines.size(); ++i)
+        StoreLine(std::move(lines[i]), i < backingBytes.size() ? backingBytes[i] : 0);
+    FinishAppend();
+}
+
+void LogView::StoreLine(LogLine&& line, std::size_t backingBytes)
+{
+    // Lines are never edited once appended, so drop any slack
+    line.text.Shrink();
+    line.spans.shrink_to_fit();
+    line.urls.shrink_to_fit();
+
+    // Charged once here and released by the same amount when dropped
+    auto bytes = static_cast<std::uint32_t>(std::min<std::size_t>(LineBytes(line) + backingBytes,
+                                                                   std::numeric_limits<std::uint32_t>::max()));
+    m_bytes += bytes;
+    Budget().totalBytes += bytes;
+    m_lineBytes.push_back(bytes);
+
+    // Only the new line is laid out; the rest of the history is untouched
+    wxClientDC dc(this);
+    MeasureLine(dc, line, m_extents);
+    m_rowCounts.push_back(CountRows(line, m_extents));
+    m_lineWidths.push_back(m_extents.empty() ? 0 : m_extents.back());
+    m_lines.push_back(std::move(line));
+}
+
+void LogView::FinishAppend()
+{
+    TrimTo(m_maxLines, m_maxBytes);
+    EnforceBudget(this);
+    ScheduleUpdate();
+}
+
+void LogView::ScheduleUpdate()
+{
+    // However many lines arrive before the event loop comes round, the
+    // window is laid out, scrolled and repainted once
+    if (m_updatePending)
+        return;
+
+    m_updatePending = true;
+    CallAfter([this]() { FlushUpdate(); });
+}
+
+void LogView::FlushUpdate()
+{
+    if (!m_updatePending)
+        return;
+    m_updatePending = false;
+
+    // Where the reader was, in the rows the window still knows about
+    std::size_t rowCount = GetRowCount();
+    bool atBottom = rowCount == 0 || GetVisibleRowsEnd() >= rowCount;
+    std::size_t firstVisible = GetVisibleRowsBegin();
+    std::size_t dropped = std::exchange(m_droppedLines, 0);
+
+    SetRowCount(m_lines.size());
+
+    // Follow new lines only from the bottom; someone reading back keeps
+    // the same lines on screen while old ones are dropped above them
+    if (atBottom)
+        ScrollToBottom();
+    else
+    {
+        ScrollToRow(firstVisible > dropped ? firstVisible - dropped : 0);
+        Refresh();
+    }
+}
+
+void LogView::Clear()
+{
+    // The backlog and shared bytes are the owner's to release
+    Budget().totalBytes -= m_bytes - m_backlogBytes - m_sharedBytes;
+    m_bytes = m_backlogBytes + m_sharedBytes;
+    m_lines.clear();
+    m_rowCounts.clear();
+    m_lineWidths.clear();
+    m_lineBytes.clear();
+    m_droppedLines = 0;
+    m_selecting = false;
+    m_hasSelection = false;
+
+    SetRowCount(0);
+    Refresh();
+}
+
+void LogView::SetDefaultColours(std::uint32_t foreground, std::uint32_t background)
+{
+    m_defaultForeground = foreground;
+    m_defaultBackground = background;
+    SetBackgroundColour(ToColour(m_defaultBackground));
+    Refresh();
+}
+
+void LogView::SetScrollbackLimits(std::size_t maxLines, std::size_t maxBytes)
+{
+    m_maxLines = maxLines;
+    m_maxBytes = maxBytes;
+    TrimTo(m_maxLines, m_maxBytes);
+}
+
+void LogView::SetBacklogBytes(std::size_t bytes)
+{
+    bool grew = bytes > m_backlogBytes;
+    m_bytes = m_bytes - m_backlogBytes + bytes;
+    Budget().totalBytes = Budget().totalBytes - m_backlogBytes + bytes;
+    m_backlogBytes = bytes;
+
+    if (grew)
+    {
+        TrimTo(m_maxLines, m_maxBytes);
+        EnforceBudget(this);
+    }
+}
+
+void LogView::SetSharedBytes(std::size_t bytes)
+{
+    if (bytes == m_sharedBytes)
+        return;
+
+    bool grew = bytes > m_sharedBytes;
+    m_bytes = m_bytes - m_sharedBytes + bytes;
+    Budget().totalBytes = Budget().totalBytes - m_sharedBytes + bytes;
+    m_sharedBytes = bytes;
+
+    if (grew)
+    {
+        TrimTo(m_maxLines, m_maxBytes);
+        EnforceBudget(this);
+    }
+}
+
+void LogView::SetBacklogTrimmer(BacklogTrimmer trimmer)
+{
+    m_backlogTrimmer = std::move(trimmer);
+}
+
+void LogView::SetMemoryBudget(std::size_t bytes)
+{
+    Budget().limit = bytes;
+    EnforceBudget(nullptr);
+}
+
+std::size_t LogView::GetTotalMemoryUsage()
+{
+    return Budget().totalBytes;
+}
+
+wxCoord LogView::OnGetRowHeight(size_t row) const
+{
+    return row < m_rowCounts.size() ? m_rowCounts[row] * m_lineHeight : m_lineHeight;
+}
+
+// -------- Layout --------
+
+void LogView::UpdateMetrics()
+{
+    // Rows are one glyph high; widths are measured per character
+    m_lineHeight = std::max(GetTextExtent("M").GetHeight(), 1);
+    m_wrapWidth = std::max(GetClientSize().GetWidth() - 2 * Margin, 1);
+}
+
+void LogView::MeasureLine(wxDC& dc, const LogLine& line, std::vector<wxCoord>& extents)
+{
+    // The same runs and fonts DrawLine uses, so that wrapping, hit testing
+    // and painting agree on where every character is
+    extents.clear();
+    extents.reserve(line.text.length());
+
+    wxArrayInt& widths = m_runWidths;
+    auto measure = [&](std::size_t begin, std::size_t end, std::uint8_t flags) {
+        wxCoord origin = EdgeBefore(extents, extents.size());
+        dc.SetFont(FontFor(flags));
+        dc.GetPartialTextExtents(line.text.Mid(begin, end - begin), widths);
+        for (std::size_t i = 0; i < end - begin; ++i)
+        {
+            // Never trust the count to match; a short answer repeats the last edge
+            wxCoord width = i < widths.GetCount() ? widths[i] : (i ? extents.back() - origin : 0);
+            extents.push_back(origin + width);
+        }
+    };
+
+    std::size_t pos = 0;
+    for (const LogSpan& span : line.spans)
+    {
+        if (span.start > pos)
+            measure(pos, span.start, 0);
+        measure(span.start, span.start + span.length, span.style.Flags());
+        pos = span.start + span.length;
+    }
+    if (pos < line.text.length())
+        measure(pos, line.text.length(), 0);
+}
+
+std::size_t LogView::WrapLine(const LogLine& line, const std::vector<wxCoord>& extents, std::vector<std::size_t>* rowStarts) const
+{
+    // Counting alone needs no list of rows
+    if (rowStarts)
+    {
+        rowStarts->clear();
+        rowStarts->push_back(0);
+    }
+
+    std::size_t rows = 1;
+    const std::size_t length = extents.size();
+    std::size_t start = 0;
+    while (start < length && extents.back() - EdgeBefore(extents, start) > m_wrapWidth)
+    {
+        // The characters that fit, and at least one
+        wxCoord limitX = EdgeBefore(extents, start) + m_wrapWidth;
+        auto limit = static_cast<std::size_t>(std::upper_bound(extents.begin() + start, extents.end(), limitX) - extents.begin());
+        limit = std::max(limit, start + 1);
+
+        // Break after the last space that fits, or mid-word if there is none
+        std::size_t breakAt = limit;
+        for (std::size_t i = limit; i > start + 1; --i)
+        {
+            if (line.text[i - 1] == ' ')
+            {
+                breakAt = i;
+                break;
+            }
+        }
+        if (breakAt > start + 1 && IsTrailingSurrogate(line.text, breakAt))
+            --breakAt;
+
+        if (rowStarts)
+            rowStarts->push_back(breakAt);
+        ++rows;
+        start = breakAt;
+    }
+    return rows;
+}
+
+std::uint16_t LogView::CountRows(const LogLine& line, const std::vector<wxCoord>& extents) const
+{
+    return static_cast<std::uint16_t>(std::min<std::size_t>(WrapLine(line, extents, nullptr), std::numeric_limits<std::uint16_t>::max()));
+}
+
+void LogView::ScrollToBottom()
+{
+    // wxVScrolledWindow clamps this so the last line sits at the bottom edge
+    if (!m_lines.empty())
+        ScrollToRow(m_lines.size() - 1);
+    Refresh();
+}
+
+// -------- Scrollback --------
+
+std::size_t LogView::LineBytes(const LogLine& line)
+{
+    // Approximate heap footprint: the deque slots, string buffer, spans and links
+    return sizeof(LogLine) + sizeof(std::uint16_t) + sizeof(wxCoord) + sizeof(std::uint32_t) +
+           (line.text.length() + 1) * sizeof(wxStringCharType) +
+           line.spans.capacity() * sizeof(LogSpan) +
+           line.urls.capacity() * sizeof(LogUrl);
+}
+
+void LogView::TrimTo(std::size_t maxLines, std::size_t maxBytes)
+{
+    // The newest line always stays, however large, unless a backlog newer
+    // than it is waiting
+    const std::size_t keep = m_backlogBytes ? 0 : 1;
+    std::size_t count = 0;
+    std::size_t bytes = m_bytes;
+    while (m_lines.size() - count > keep &&
+           ((maxLines && m_lines.size() - count > maxLines) || (maxBytes && bytes > maxBytes)))
+    {
+        bytes -= m_lineBytes[count];
+        ++count;
+    }
+
+    if (count > 0)
+        DropOldestLines(count);
+
+    // With every line gone, the oldest backlog goes next
+    if (maxBytes && m_bytes > maxBytes && m_lines.empty() && m_backlogBytes && m_backlogTrimmer)
+    {
+        std::size_t freed = std::min(m_backlogTrimmer(m_bytes - maxBytes), m_backlogBytes);
+        m_backlogBytes -= freed;
+        m_bytes -= freed;
+        Budget().totalBytes -= freed;
+    }
+}
+
+void LogView::DropOldestLines(std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::size_t bytes = m_lineBytes.front();
+        m_bytes -= bytes;
+        Budget().totalBytes -= bytes;
+        m_lines.pop_front();
+        m_rowCounts.pop_front();
+        m_lineWidths.pop_front();
+        m_lineBytes.pop_front();
+    }
+
+    // Keep the selection on the same text, or drop it if that text is gone
+    if (m_hasSelection || m_selecting)
+    {
+        if (std::min(m_anchor, m_caret).line < count)
+        {
+            m_hasSelection = false;
+            m_selecting = false;
+        }
+        else
+        {
+            m_anchor.line -= count;
+            m_caret.line -= count;
+        }
+    }
+
+    // Row indices shifted; the next update keeps the same lines on screen
+    m_droppedLines += count;
+    ScheduleUpdate();
+}
+
+void LogView::EnforceBudget(LogView* appended)
+{
+    ScrollbackBudget& budget = Budget();
+    if (budget.limit == 0 || budget.totalBytes <= budget.limit)
+        return;
+
+    // Views holding more than an even share give up their oldest lines,
+    // starting with the one that just grew; quiet tabs keep their history
+    // as long as they stay under it
+    std::size_t share = budget.limit / budget.views.size();
+    if (appended)
+        appended->TrimTo(0, share);
+
+    for (LogView* view : budget.views)
+    {
+        if (budget.totalBytes <= budget.limit)
+            break;
+        if (view != appended)
+            view->TrimTo(0, share);
+    }
+}
+
+void LogView::OnSize(wxSizeEvent& evt)
+{
+    FlushUpdate();
+    bool atBottom = m_lines.empty() || GetVisibleRowsEnd() >= m_lines.size();
+
+    wxCoord oldWidth = m_wrapWidth;
+    UpdateMetrics();
+
+    // Re-wrapping is the only full pass, and only when the width actually
+    // changes; a line that fits on one row is not measured again
+    if (m_wrapWidth != oldWidth)
+    {
+        wxClientDC dc(this);
+        for (std::size_t i = 0; i < m_lines.size(); ++i)
+        {
+            if (m_lineWidths[i] <= m_wrapWidth)
+            {
+                m_rowCounts[i] = 1;
+                continue;
+            }
+            MeasureLine(dc, m_lines[i], m_extents);
+            m_rowCounts[i] = CountRows(m_lines[i], m_extents);
+        }
+        RefreshAll();
+    }
+
+    if (atBottom)
+        ScrollToBottom();
+
+    evt.Skip();
+}
+
+// -------- Painting --------
+
+void LogView::OnPaint(wxPaintEvent&)
+{
+    // Rows must match the lines before anything is drawn from them
+    FlushUpdate();
+
+    wxAutoBufferedPaintDC dc(this);
+    dc.SetBackground(wxBrush(ToColour(m_defaultBackground)));
+    dc.Clear();
+
+    // Only the lines on screen are visited
+    wxCoord y = 0;
+    wxCoord height = GetClientSize().GetHeight();
+    for (std::size_t i = GetVisibleRowsBegin(); i < GetVisibleRowsEnd() && i < m_lines.size() && y < height; ++i)
+    {
+        DrawLine(dc, i, y);
+        y += OnGetRowHeight(i);
+    }
+}
+
+void LogView::DrawLine(wxDC& dc, std::size_t index, wxCoord y)
+{
+    const LogLine& line = m_lines[index];
+
+    const std::vector<wxCoord>& extents = m_extents;
+    const std::vector<std::size_t>& rowStarts = m_rowStarts;
+    MeasureLine(dc, line, m_extents);
+    WrapLine(line, m_extents, &m_rowStarts);
+
+    // Part of this line that is selected, as [selFrom, selTo)
+    std::size_t selFrom = 0;
+    std::size_t selTo = 0;
+    if (m_hasSelection)
+    {
+        TextPos from = std::min(m_anchor, m_caret);
+        TextPos to = std::max(m_anchor, m_caret);
+        if (from.line <= index && index <= to.line)
+        {
+            selFrom = from.line == index ? from.offset : 0;
+            selTo = to.line == index ? to.offset : line.text.length();
+        }
+    }
+
+    // Runs are placed by the measured extents, not by their own width, so
+    // they land exactly where hit testing expects them
+    auto drawRun = [&](std::size_t begin, std::size_t end, const LogStyle& style, bool selected, wxCoord rowX, wxCoord rowY) {
+        wxString run = line.text.Mid(begin, end - begin);
+        dc.SetFont(FontFor(style.Flags()));
+        wxCoord x = rowX + EdgeBefore(extents, begin);
+        wxCoord width = extents[end - 1] - EdgeBefore(extents, begin);
+
+        if (selected || (style.Flags() & LogStyle::HasBackground))
+        {
+            dc.SetPen(*wxTRANSPARENT_PEN);
+            dc.SetBrush(wxBrush(selected ? ToColour(SelectionBackground) : ColourFor(style.Background())));
+            dc.DrawRectangle(x, rowY, width, m_lineHeight);
+        }
+
+        dc.SetTextForeground(ColourFor(style.Foreground()));
+        dc.DrawText(run, x, rowY);
+    };
+
+    for (std::size_t row = 0; row < rowStarts.size(); ++row)
+    {
+        std::size_t rowBegin = rowStarts[row];
+        std::size_t rowEnd = row + 1 < rowStarts.size() ? rowStarts[row + 1] : line.text.length();
+        wxCoord rowY = y + static_cast<wxCoord>(row) * m_lineHeight;
+        wxCoord rowX = Margin - EdgeBefore(extents, rowBegin);
+
+        for (const LogSpan& span : line.spans)
+        {
+            std::size_t begin = std::max<std::size_t>(span.start, rowBegin);
+            std::size_t end = std::min<std::size_t>(span.start + span.length, rowEnd);
+            if (begin >= end)
+                continue;
+
+            // Split the piece where the selection starts and ends
+            std::size_t cuts[] = { begin, std::clamp(selFrom, begin, end), std::clamp(selTo, begin, end), end };
+            for (int c = 0; c < 3; ++c)
+            {
+                if (cuts[c] < cuts[c + 1])
+                    drawRun(cuts[c], cuts[c + 1], span.style, c == 1, rowX, rowY);
+            }
+        }
+    }
+}
+
+// -------- Mouse --------
+
+bool LogView::HitTest(const wxPoint& pt, TextPos& pos)
+{
+    if (m_lines.empty())
+        return false;
+
+    // Find the line under the point, walking down from the top of the view
+    std::size_t index = GetVisibleRowsBegin();
+    wxCoord top = 0;
+    if (pt.y < 0)
+    {
+        pos = TextPos{ index, 0 };
+        return false;
+    }
+    while (index < m_lines.size() && pt.y >= top + OnGetRowHeight(index))
+    {
+        top += OnGetRowHeight(index);
+        ++index;
+    }
+    if (index >= m_lines.size())
+    {
+        // Below the last line: clamp to the end of the text
+        pos = TextPos{ m_lines.size() - 1, m_lines.back().text.length() };
+        return false;
+    }
+
+    // Laid out exactly as DrawLine lays it out
+    const LogLine& line = m_lines[index];
+    wxClientDC dc(this);
+    const std::vector<wxCoord>& extents = m_extents;
+    const std::vector<std::size_t>& rowStarts = m_rowStarts;
+    MeasureLine(dc, line, m_extents);
+    WrapLine(line, m_extents, &m_rowStarts);
+
+    std::size_t row = std::min<std::size_t>((pt.y - top) / m_lineHeight, rowStarts.size() - 1);
+    std::size_t rowBegin = rowStarts[row];
+    std::size_t rowEnd = row + 1 < rowStarts.size() ? rowStarts[row + 1] : line.text.length();
+
+    // The character whose extent covers the point
+    wxCoord x = EdgeBefore(extents, rowBegin) + std::max(pt.x - Margin, 0);
+    auto offset = static_cast<std::size_t>(std::upper_bound(extents.begin() + rowBegin, extents.begin() + rowEnd, x) - extents.begin());
+    if (IsTrailingSurrogate(line.text, offset))
+        --offset;
+    pos = TextPos{ index, offset };
+    return offset < rowEnd;
+}
+
+const LogUrl* LogView::UrlAt(const TextPos& pos) const
+{
+    if (pos.line >= m_lines.size())
+        return nullptr;
+    return m_lines[pos.line].UrlAt(pos.offset);
+}
+
+wxString LogView::GetSelectedText() const
+{
+    TextPos from = std::min(m_anchor, m_caret);
+    TextPos to = std::max(m_anchor, m_caret);
+
+    wxString text;
+    for (std::size_t i = from.line; i <= to.line && i < m_lines.size(); ++i)
+    {
+        const wxString& lineText = m_lines[i].text;
+        std::size_t begin = i == from.line ? from.offset : 0;
+        std::size_t end = i == to.line ? to.offset : lineText.length();
+        if (i != from.line)
+            text += "\n";
+        text += lineText.Mid(begin, end - begin);
+    }
+    return text;
+}
+
+void LogView::OnMouseDown(wxMouseEvent& evt)
+{
+    FlushUpdate();
+    bool hadSelection = m_hasSelection;
+    m_hasSelection = false;
+
+    TextPos pos;
+    HitTest(evt.GetPosition(), pos);
+    m_anchor = pos;
+    m_caret = pos;
+    m_selecting = !m_lines.empty();
+
+    if (m_selecting && !HasCapture())
+        CaptureMouse();
+    if (hadSelection)
+        Refresh();
+}
+
+void LogView::OnMouseMove(wxMouseEvent& evt)
+{
+    FlushUpdate();
+    TextPos pos;
+    bool onText = HitTest(evt.GetPosition(), pos);
+
+    if (m_selecting && evt.LeftIsDown())
+    {
+        if (!(pos == m_caret))
+        {
+            m_caret = pos;
+            m_hasSelection = !(m_anchor == m_caret);
+            Refresh();
+        }
+        return;
+    }
+
+    // Hand cursor over links
+    bool overUrl = onText && UrlAt(pos);
+    if (overUrl != m_handCursor)
+    {
+        m_handCursor = overUrl;
+        SetCursor(wxCursor(overUrl ? wxCURSOR_HAND : wxCURSOR_ARROW));
+    }
+    evt.Skip();
+}
+
+void LogView::OnMouseUp(wxMouseEvent& evt)
+{
+    if (HasCapture())
+        ReleaseMouse();
+
+    if (!m_selecting)
+        return;
+    m_selecting = false;
+
+    // Dragging copies, like a terminal; the log is never focused, so there
+    // is nowhere for a Ctrl+C to go
+    if (m_hasSelection)
+    {
+        wxString text = GetSelectedText();
+        if (!text.IsEmpty() && wxTheClipboard->Open())
+        {
+            wxTheClipboard->SetData(new wxTextDataObject(text));
+            wxTheClipboard->Close();
+        }
+        return;
+    }
+
+    // A plain click on a link opens it
+    TextPos pos;
+    if (!HitTest(evt.GetPosition(), pos))
+        return;
+
+    const LogUrl* link = UrlAt(pos);
+    if (!link)
+        return;
+
+    wxString url = m_lines[pos.line].text.Mid(link->start, link->length);
+    if (url.StartsWith("www."))
+        url = "http://" + url;
+    wxLaunchDefaultBrowser(url);
+}
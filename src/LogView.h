@@ -0,0 +1,170 @@
+#pragma once
+
+#include <wx/vscroll.h>
+#include <wx/dynarray.h>
+#include <wx/font.h>
+#include <wx/string.h>
+#include "LogFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// -------------------------------------------------------
+// LogView
+// Owner-drawn, virtualized log control. Lines are kept as LogLine models
+// and only the rows on screen are laid out and painted, so appending and
+// scrolling cost the same however much history there is. Long lines wrap
+// at word boundaries, by the measured width of each character in its own
+// font, so wide characters and fallback glyphs wrap, select and click
+// where they are drawn; a drag selects text and copies it to the clipboard,
+// a click on a URL opens it. Fonts and colours come from one cache shared
+// by all views, keyed by the style word of each run.
+//
+// History is bounded: each view has its own line/byte limits, and all views
+// together share a process-wide memory budget. When the budget is exceeded
+// the views holding more than an even share give up their oldest lines.
+// -------------------------------------------------------
+
+class LogView : public wxVScrolledWindow
+{
+public:
+    explicit LogView(wxWindow* parent, wxWindowID id = wxID_ANY);
+    ~LogView() override;
+
+    // backingBytes is heap the owner keeps for the line elsewhere (e.g. the
+    // stored message it was rendered from); it is charged to the limits
+    // and the budget along with the line and released when the line goes.
+    // AppendLines takes none, or one per line.
+    void AppendLine(LogLine line, std::size_t backingBytes = 0);
+    void AppendLines(std::vector<LogLine> lines, const std::vector<std::size_t>& backingBytes = {});
+    void Clear();
+
+    void SetDefaultColours(std::uint32_t foreground, std::uint32_t background);
+    std::size_t GetLineCount() const { return m_lines.size(); }
+
+    // Scrollback limits for this view (0 = unlimited)
+    void SetScrollbackLimits(std::size_t maxLines, std::size_t maxBytes);
+
+    // Approximate heap held by this view's history, backing bytes, shared
+    // bytes and backlog included
+    std::size_t GetMemoryUsage() const { return m_bytes; }
+
+    // Heap the owner holds for messages it has not appended yet, e.g. while
+    // its tab is hidden. The backlog is newer than every line, counts toward
+    // the byte limit and the budget like them, and is given up last: once
+    // trimming has taken every line, the trimmer is asked to drop at least
+    // `bytes` of the oldest backlog and returns how much it released.
+    using BacklogTrimmer = std::function<std::size_t(std::size_t bytes)>;
+    void SetBacklogBytes(std::size_t bytes);
+    void SetBacklogTrimmer(BacklogTrimmer trimmer);
+
+    // Heap the owner holds for all lines together rather than any one of
+    // them, e.g. a table they refer to. Counts toward the byte limit and
+    // the budget, but only the owner can release it.
+    void SetSharedBytes(std::size_t bytes);
+
+    // Cap on all views together (0 = unlimited), and what they hold now.
+    // GUI thread only, like the views themselves.
+    static void SetMemoryBudget(std::size_t bytes);
+    static std::size_t GetTotalMemoryUsage();
+
+    // Never take focus; the owner redirects it to the input box
+    bool AcceptsFocus() const override { return false; }
+    bool AcceptsFocusFromKeyboard() const override { return false; }
+
+protected:
+    wxCoord OnGetRowHeight(size_t row) const override;
+
+private:
+    // Character position inside the model
+    struct TextPos
+    {
+        std::size_t line = 0;
+        std::size_t offset = 0;
+
+        bool operator<(const TextPos& other) const
+        {
+            return line < other.line || (line == other.line && offset < other.offset);
+        }
+        bool operator==(const TextPos& other) const
+        {
+            return line == other.line && offset == other.offset;
+        }
+    };
+
+    void OnPaint(wxPaintEvent& evt);
+    void OnSize(wxSizeEvent& evt);
+    void OnMouseDown(wxMouseEvent& evt);
+    void OnMouseMove(wxMouseEvent& evt);
+    void OnMouseUp(wxMouseEvent& evt);
+
+    // Appending: store each line, then trim, lay out and scroll once
+    void StoreLine(LogLine&& line, std::size_t backingBytes);
+    void FinishAppend();
+
+    // Row count and scroll position are brought up to date once per event
+    // loop iteration, or before painting and hit testing if sooner
+    void ScheduleUpdate();
+    void FlushUpdate();
+
+    // Layout. Extents are the right edge of each character, from the start
+    // of the line, in the fonts it is drawn with.
+    void UpdateMetrics();
+    void MeasureLine(wxDC& dc, const LogLine& line, std::vector<wxCoord>& extents);
+    std::size_t WrapLine(const LogLine& line, const std::vector<wxCoord>& extents, std::vector<std::size_t>* rowStarts) const;
+    std::uint16_t CountRows(const LogLine& line, const std::vector<wxCoord>& extents) const;
+    void ScrollToBottom();
+
+    // Scrollback
+    static std::size_t LineBytes(const LogLine& line);
+    void DropOldestLines(std::size_t count);
+    void TrimTo(std::size_t maxLines, std::size_t maxBytes);
+    static void EnforceBudget(LogView* appended);
+
+    // Hit testing
+    bool HitTest(const wxPoint& pt, TextPos& pos);
+    const LogUrl* UrlAt(const TextPos& pos) const;
+    wxString GetSelectedText() const;
+
+    void DrawLine(wxDC& dc, std::size_t index, wxCoord y);
+
+    // Deques so the oldest lines come off the front in constant time
+    std::deque<LogLine> m_lines;
+    std::deque<std::uint16_t> m_rowCounts;  // wrapped rows per line at the current width
+    std::deque<wxCoord> m_lineWidths;       // unwrapped, so a resize only re-wraps lines that overflow
+    std::deque<std::uint32_t> m_lineBytes;  // charged per line, backing bytes included
+
+    // Scratch for laying out one line, reused so painting, hit testing and
+    // appending allocate nothing once they have grown
+    std::vector<wxCoord> m_extents;
+    std::vector<std::size_t> m_rowStarts;
+    wxArrayInt m_runWidths;
+
+    bool m_updatePending = false;
+    std::size_t m_droppedLines = 0;  // from the front since the last update
+
+    std::size_t m_bytes = 0;
+    std::size_t m_backlogBytes = 0;  // part of m_bytes
+    std::size_t m_sharedBytes = 0;   // part of m_bytes
+    BacklogTrimmer m_backlogTrimmer;
+    std::size_t m_maxLines = 0;
+    std::size_t m_maxBytes = 0;
+
+    std::uint32_t m_defaultForeground = LogDefaultForeground;
+    std::uint32_t m_defaultBackground = LogDefaultBackground;
+
+    // Row metrics
+    wxCoord m_lineHeight = 16;
+    wxCoord m_wrapWidth = 640;  // text width of a row
+
+    // Selection (anchor is where the drag started)
+    bool m_selecting = false;
+    bool m_hasSelection = false;
+    TextPos m_anchor;
+    TextPos m_caret;
+
+    bool m_handCursor = false;
+};
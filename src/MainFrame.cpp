@@ -1,5 +1,7 @@
 #include "MainFrame.h"
+#include "LogView.h"
 #include "ServerConnectionPanel.h"
+#include "irc_resolver.h"
 
 #include <wx/menu.h>
 #include <wx/msgdlg.h>
@@ -11,6 +13,7 @@
 #include <wx/radiobut.h>
 #include <wx/statbox.h>
 #include <wx/spinctrl.h>
+#include <algorithm>
 
 // ---------- PreferencesDialog (local to this file) ----------
 
@@ -74,6 +77,78 @@ public:
 
         mainSizer->Add(connectionBox, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
 
+        // Flood control section
+        auto* floodBox = new wxStaticBoxSizer(wxVERTICAL, this, "Flood control");
+
+        m_floodEnabled = new wxCheckBox(this, wxID_ANY, "Limit how fast lines are sent");
+        m_floodEnabled->SetValue(m_settings.floodControl.enabled);
+        floodBox->Add(m_floodEnabled, 0, wxALL, 5);
+
+        auto* burstRow = new wxBoxSizer(wxHORIZONTAL);
+        auto* burstLabel = new wxStaticText(this, wxID_ANY, "Lines sent at once:");
+        m_floodBurst = new wxSpinCtrl(this, wxID_ANY);
+        m_floodBurst->SetRange(1, 100);
+        m_floodBurst->SetValue(m_settings.floodControl.burstLines);
+
+        burstRow->Add(burstLabel, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+        burstRow->Add(m_floodBurst, 0);
+        floodBox->Add(burstRow, 0, wxALL, 5);
+
+        auto* intervalRow = new wxBoxSizer(wxHORIZONTAL);
+        auto* intervalLabel = new wxStaticText(this, wxID_ANY, "Then one line every (ms):");
+        m_floodInterval = new wxSpinCtrl(this, wxID_ANY);
+        m_floodInterval->SetRange(100, 10000);
+        m_floodInterval->SetValue(m_settings.floodControl.refillIntervalMs);
+
+        intervalRow->Add(intervalLabel, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+        intervalRow->Add(m_floodInterval, 0);
+        floodBox->Add(intervalRow, 0, wxALL, 5);
+
+        auto* floodNote = new wxStaticText(this, wxID_ANY, "(PONG and QUIT are never delayed)");
+        floodNote->SetFont(noteFont);
+        floodBox->Add(floodNote, 0, wxLEFT, 20);
+
+        mainSizer->Add(floodBox, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+
+        // Scrollback section
+        auto* scrollbackBox = new wxStaticBoxSizer(wxVERTICAL, this, "Scrollback");
+
+        auto* linesRow = new wxBoxSizer(wxHORIZONTAL);
+        auto* linesLabel = new wxStaticText(this, wxID_ANY, "Lines kept per tab:");
+        m_scrollbackLines = new wxSpinCtrl(this, wxID_ANY);
+        m_scrollbackLines->SetRange(0, 1000000);
+        m_scrollbackLines->SetValue(m_settings.scrollbackLines);
+
+        linesRow->Add(linesLabel, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+        linesRow->Add(m_scrollbackLines, 0);
+        scrollbackBox->Add(linesRow, 0, wxALL, 5);
+
+        auto* kilobytesRow = new wxBoxSizer(wxHORIZONTAL);
+        auto* kilobytesLabel = new wxStaticText(this, wxID_ANY, "Memory per tab (KB):");
+        m_scrollbackKilobytes = new wxSpinCtrl(this, wxID_ANY);
+        m_scrollbackKilobytes->SetRange(0, 1048576);
+        m_scrollbackKilobytes->SetValue(m_settings.scrollbackKilobytes);
+
+        kilobytesRow->Add(kilobytesLabel, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+        kilobytesRow->Add(m_scrollbackKilobytes, 0);
+        scrollbackBox->Add(kilobytesRow, 0, wxALL, 5);
+
+        auto* budgetRow = new wxBoxSizer(wxHORIZONTAL);
+        auto* budgetLabel = new wxStaticText(this, wxID_ANY, "Memory for all tabs (MB):");
+        m_scrollbackBudget = new wxSpinCtrl(this, wxID_ANY);
+        m_scrollbackBudget->SetRange(0, 65536);
+        m_scrollbackBudget->SetValue(m_settings.scrollbackBudgetMegabytes);
+
+        budgetRow->Add(budgetLabel, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+        budgetRow->Add(m_scrollbackBudget, 0);
+        scrollbackBox->Add(budgetRow, 0, wxALL, 5);
+
+        auto* scrollbackNote = new wxStaticText(this, wxID_ANY, "(0 = unlimited; oldest lines are dropped first)");
+        scrollbackNote->SetFont(noteFont);
+        scrollbackBox->Add(scrollbackNote, 0, wxLEFT, 20);
+
+        mainSizer->Add(scrollbackBox, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+
         // Buttons
         auto* btnOk = new wxButton(this, wxID_OK, "OK");
         auto* btnCancel = new wxButton(this, wxID_CANCEL, "Cancel");
@@ -93,11 +168,19 @@ public:
 
     AppSettings GetSettings() const
     {
-        AppSettings settings;
+        // Start from the current settings so fields without a control here
+        // (e.g. per-server flood limits) are kept
+        AppSettings settings = m_settings;
         settings.showTimestamps = m_showTimestamps->GetValue();
         settings.use24HourFormat = m_format24Hour->GetValue();
         settings.autoReconnect = m_autoReconnect->GetValue();
         settings.maxReconnectAttempts = m_maxAttempts->GetValue();
+        settings.floodControl.enabled = m_floodEnabled->GetValue();
+        settings.floodControl.burstLines = m_floodBurst->GetValue();
+        settings.floodControl.refillIntervalMs = m_floodInterval->GetValue();
+        settings.scrollbackLines = m_scrollbackLines->GetValue();
+        settings.scrollbackKilobytes = m_scrollbackKilobytes->GetValue();
+        settings.scrollbackBudgetMegabytes = m_scrollbackBudget->GetValue();
         return settings;
     }
 
@@ -108,6 +191,12 @@ private:
     wxRadioButton* m_format12Hour = nullptr;
     wxCheckBox* m_autoReconnect = nullptr;
     wxSpinCtrl* m_maxAttempts = nullptr;
+    wxCheckBox* m_floodEnabled = nullptr;
+    wxSpinCtrl* m_floodBurst = nullptr;
+    wxSpinCtrl* m_floodInterval = nullptr;
+    wxSpinCtrl* m_scrollbackLines = nullptr;
+    wxSpinCtrl* m_scrollbackKilobytes = nullptr;
+    wxSpinCtrl* m_scrollbackBudget = nullptr;
 };
 
 // ---------- QuickConnectDialog (local to this file) ----------
@@ -116,13 +205,15 @@ class QuickConnectDialog : public wxDialog
 {
 public:
     QuickConnectDialog(wxWindow* parent,
+                       const AppSettings& settings,
                        const wxString& defaultServer,
                        const wxString& defaultPort,
                        const wxString& defaultNick,
                        const wxString& defaultPassword = "")
         : wxDialog(parent, wxID_ANY, "Quick Connect",
                    wxDefaultPosition, wxDefaultSize,
-                   wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
+                   wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
+          m_settings(settings)
     {
         auto* serverLabel = new wxStaticText(this, wxID_ANY, "Server:");
         auto* portLabel = new wxStaticText(this, wxID_ANY, "Port:");
@@ -152,6 +243,30 @@ public:
         noteFont.SetPointSize(noteFont.GetPointSize() - 1);
         passwordNote->SetFont(noteFont);
 
+        // Flood control for this host, overriding the one in Preferences
+        auto* floodBox = new wxStaticBoxSizer(wxVERTICAL, this, "Flood control for this server");
+
+        m_floodOverride = new wxCheckBox(this, wxID_ANY, "Use different limits than in Preferences");
+        floodBox->Add(m_floodOverride, 0, wxALL, 5);
+
+        m_floodEnabled = new wxCheckBox(this, wxID_ANY, "Limit how fast lines are sent");
+        floodBox->Add(m_floodEnabled, 0, wxLEFT | wxRIGHT | wxBOTTOM, 5);
+
+        auto* floodRow = new wxBoxSizer(wxHORIZONTAL);
+        m_floodBurst = new wxSpinCtrl(this, wxID_ANY);
+        m_floodBurst->SetRange(1, 100);
+        m_floodInterval = new wxSpinCtrl(this, wxID_ANY);
+        m_floodInterval->SetRange(100, 10000);
+        floodRow->Add(new wxStaticText(this, wxID_ANY, "Burst:"), 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+        floodRow->Add(m_floodBurst, 0, wxRIGHT, 10);
+        floodRow->Add(new wxStaticText(this, wxID_ANY, "then one line every (ms):"), 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+        floodRow->Add(m_floodInterval, 0);
+        floodBox->Add(floodRow, 0, wxLEFT | wxRIGHT | wxBOTTOM, 5);
+
+        LoadFloodControl();
+        m_serverCtrl->Bind(wxEVT_TEXT, [this](wxCommandEvent&) { LoadFloodControl(); });
+        m_floodOverride->Bind(wxEVT_CHECKBOX, [this](wxCommandEvent&) { UpdateFloodControls(); });
+
         auto* btnOk = new wxButton(this, wxID_OK, "Connect");
         auto* btnCancel = new wxButton(this, wxID_CANCEL, "Cancel");
 
@@ -163,6 +278,7 @@ public:
         auto* mainSizer = new wxBoxSizer(wxVERTICAL);
         mainSizer->Add(formSizer, 0, wxEXPAND | wxALL, 10);
         mainSizer->Add(passwordNote, 0, wxLEFT | wxRIGHT | wxBOTTOM, 10);
+        mainSizer->Add(floodBox, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
         mainSizer->Add(btnSizer, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
 
         SetSizerAndFit(mainSizer);
@@ -176,11 +292,49 @@ public:
     wxString GetNick() const { return m_nickCtrl->GetValue(); }
     wxString GetPassword() const { return m_passwordCtrl->GetValue(); }
 
+    // The limits chosen for this server; false if it uses the global ones
+    bool GetFloodOverride(FloodControlSettings& flood) const
+    {
+        if (!m_floodOverride->GetValue())
+            return false;
+
+        flood.enabled = m_floodEnabled->GetValue();
+        flood.burstLines = m_floodBurst->GetValue();
+        flood.refillIntervalMs = m_floodInterval->GetValue();
+        return true;
+    }
+
 private:
+    // Show the limits saved for the host typed so far
+    void LoadFloodControl()
+    {
+        std::string host(m_serverCtrl->GetValue().ToUTF8());
+        const FloodControlSettings& flood = m_settings.floodControlFor(host);
+
+        m_floodOverride->SetValue(m_settings.serverFloodControl.count(host) != 0);
+        m_floodEnabled->SetValue(flood.enabled);
+        m_floodBurst->SetValue(flood.burstLines);
+        m_floodInterval->SetValue(flood.refillIntervalMs);
+        UpdateFloodControls();
+    }
+
+    void UpdateFloodControls()
+    {
+        bool custom = m_floodOverride->GetValue();
+        m_floodEnabled->Enable(custom);
+        m_floodBurst->Enable(custom);
+        m_floodInterval->Enable(custom);
+    }
+
+    const AppSettings& m_settings;
     wxTextCtrl* m_serverCtrl = nullptr;
     wxTextCtrl* m_portCtrl = nullptr;
     wxTextCtrl* m_nickCtrl = nullptr;
     wxTextCtrl* m_passwordCtrl = nullptr;
+    wxCheckBox* m_floodOverride = nullptr;
+    wxCheckBox* m_floodEnabled = nullptr;
+    wxSpinCtrl* m_floodBurst = nullptr;
+    wxSpinCtrl* m_floodInterval = nullptr;
 };
 
 // ---------- Menu IDs ----------
@@ -242,6 +396,9 @@ MainFrame::MainFrame()
     m_serverNotebook->Bind(wxEVT_AUINOTEBOOK_PAGE_CLOSE,
                            &MainFrame::OnServerTabClosed,
                            this);
+    m_serverNotebook->Bind(wxEVT_AUINOTEBOOK_PAGE_CHANGED,
+                           &MainFrame::OnServerTabChanged,
+                           this);
 
     mainSizer->Add(m_serverNotebook, 1, wxEXPAND | wxALL, 5);
     SetSizer(mainSizer);
@@ -251,6 +408,14 @@ MainFrame::MainFrame()
     m_defaultPort = "6667";
     m_defaultNick = "AstraUser";
 
+    // Resolve the servers we know about while the user is still looking at
+    // the window, so the first connect starts from cached addresses
+    IRCResolver::instance().prefetch(std::string(m_defaultServer.ToUTF8()));
+    for (const auto& [host, floodSettings] : m_settings.serverFloodControl)
+        IRCResolver::instance().prefetch(host);
+
+    ApplyScrollbackBudget();
+
     // Menu bindings
     Bind(wxEVT_MENU, &MainFrame::OnMenuExit, this, wxID_EXIT);
     Bind(wxEVT_MENU, &MainFrame::OnMenuConnect, this, ID_Menu_Connect);
@@ -271,7 +436,7 @@ void MainFrame::OnMenuExit(wxCommandEvent&)
 
 void MainFrame::OnMenuConnect(wxCommandEvent&)
 {
-    QuickConnectDialog dlg(this, m_defaultServer, m_defaultPort, m_defaultNick, m_defaultPassword);
+    QuickConnectDialog dlg(this, m_settings, m_defaultServer, m_defaultPort, m_defaultNick, m_defaultPassword);
     if (dlg.ShowModal() != wxID_OK)
         return;
 
@@ -293,11 +458,22 @@ void MainFrame::OnMenuConnect(wxCommandEvent&)
     m_defaultNick = nick;
     m_defaultPassword = password;
 
+    // Remember this server's own flood limits, or that it has none; other
+    // connections to the same host pick the change up too
+    std::string host(server.ToUTF8());
+    FloodControlSettings flood;
+    if (dlg.GetFloodOverride(flood))
+        m_settings.serverFloodControl[host] = flood;
+    else
+        m_settings.serverFloodControl.erase(host);
+    ApplySettingsToPanels();
+
     // Create a new server connection panel
     auto* serverPanel = new ServerConnectionPanel(m_serverNotebook, server, port, nick, m_settings, password);
     wxString tabTitle = GenerateServerTabTitle(server, nick);
 
     m_serverNotebook->AddPage(serverPanel, tabTitle, true);
+    UpdateShownServerPanel();
 
     SetStatusText("Connecting to " + server + ":" + port + "...");
 }
@@ -354,20 +530,30 @@ void MainFrame::OnMenuPreferences(wxCommandEvent&)
     if (dlg.ShowModal() == wxID_OK)
     {
         m_settings = dlg.GetSettings();
+        ApplyScrollbackBudget();
+        ApplySettingsToPanels();
+    }
+}
 
-        // Apply settings to all server panels
-        if (m_serverNotebook)
-        {
-            for (size_t i = 0; i < m_serverNotebook->GetPageCount(); ++i)
-            {
-                ServerConnectionPanel* panel = dynamic_cast<ServerConnectionPanel*>(m_serverNotebook->GetPage(i));
-                if (panel)
-                    panel->ApplySettings(m_settings);
-            }
-        }
+void MainFrame::ApplySettingsToPanels()
+{
+    if (!m_serverNotebook)
+        return;
+
+    for (size_t i = 0; i < m_serverNotebook->GetPageCount(); ++i)
+    {
+        ServerConnectionPanel* panel = dynamic_cast<ServerConnectionPanel*>(m_serverNotebook->GetPage(i));
+        if (panel)
+            panel->ApplySettings(m_settings);
     }
 }
 
+void MainFrame::ApplyScrollbackBudget()
+{
+    // Shared by every tab of every connection
+    LogView::SetMemoryBudget(static_cast<std::size_t>(std::max(m_settings.scrollbackBudgetMegabytes, 0)) * 1024 * 1024);
+}
+
 void MainFrame::OnMenuAbout(wxCommandEvent&)
 {
     wxMessageBox(
@@ -408,6 +594,26 @@ ServerConnectionPanel* MainFrame::GetCurrentServerPanel()
     return dynamic_cast<ServerConnectionPanel*>(page);
 }
 
+void MainFrame::OnServerTabChanged(wxAuiNotebookEvent& evt)
+{
+    // Channel tab changes inside a connection bubble up here too
+    if (evt.GetEventObject() == m_serverNotebook)
+        UpdateShownServerPanel();
+    evt.Skip();
+}
+
+void MainFrame::UpdateShownServerPanel()
+{
+    // Connections in background tabs don't render their logs
+    int selection = m_serverNotebook->GetSelection();
+    for (size_t i = 0; i < m_serverNotebook->GetPageCount(); ++i)
+    {
+        ServerConnectionPanel* panel = dynamic_cast<ServerConnectionPanel*>(m_serverNotebook->GetPage(i));
+        if (panel)
+            panel->SetShown(static_cast<int>(i) == selection);
+    }
+}
+
 wxString MainFrame::GenerateServerTabTitle(const wxString& server, const wxString& nick)
 {
     return server + " (" + nick + ")";
@@ -22,9 +22,13 @@ private:
     void OnMenuAbout(wxCommandEvent& evt);
     void OnActivate(wxActivateEvent& evt);
     void OnServerTabClosed(wxAuiNotebookEvent& evt);
+    void OnServerTabChanged(wxAuiNotebookEvent& evt);
 
     ServerConnectionPanel* GetCurrentServerPanel();
     wxString GenerateServerTabTitle(const wxString& server, const wxString& nick);
+    void ApplyScrollbackBudget();
+    void ApplySettingsToPanels();
+    void UpdateShownServerPanel();
 
 private:
     wxAuiNotebook* m_serverNotebook = nullptr;
@@ -0,0 +1,147 @@
+#include "MessageStore.h"
+
+#include <algorithm>
+
+// Don't bother compacting tiny prefixes
+static constexpr std::size_t MinCompactCount = 256;
+
+std::size_t MessageStore::Append(std::int64_t time, MessageKind kind, std::uint8_t flags,
+                                 std::string_view nick, std::string_view text)
+{
+    m_times.push_back(time);
+    m_nicks.push_back(Intern(nick));
+    m_kinds.push_back(kind);
+    m_flags.push_back(flags);
+    m_textStarts.push_back(static_cast<std::uint32_t>(m_arena.size()));
+    m_arena.append(text);
+
+    return Size() - 1;
+}
+
+std::string_view MessageStore::Text(std::size_t index) const
+{
+    std::size_t i = m_first + index;
+    std::size_t begin = m_textStarts[i];
+    std::size_t end = i + 1 < m_textStarts.size() ? m_textStarts[i + 1] : m_arena.size();
+    return std::string_view(m_arena).substr(begin, end - begin);
+}
+
+void MessageStore::DropFront(std::size_t count)
+{
+    m_first += std::min(count, Size());
+
+    if (m_first == m_times.size())
+        Clear();
+    else if (m_first >= MinCompactCount && m_first * 2 >= m_times.size())
+        Compact();
+}
+
+void MessageStore::Clear()
+{
+    m_times.clear();
+    m_nicks.clear();
+    m_kinds.clear();
+    m_flags.clear();
+    m_textStarts.clear();
+    m_first = 0;
+    m_arena.clear();
+
+    // Nick IDs are only meaningful alongside the messages using them
+    m_nickNames.resize(1);
+    m_nickIds.clear();
+    m_nickBytes = 0;
+}
+
+void MessageStore::Compact()
+{
+    // Each message moves at most once per halving, so dropping stays
+    // amortized constant time
+    std::uint32_t arenaStart = m_textStarts[m_first];
+    auto drop = static_cast<std::ptrdiff_t>(m_first);
+
+    m_times.erase(m_times.begin(), m_times.begin() + drop);
+    m_nicks.erase(m_nicks.begin(), m_nicks.begin() + drop);
+    m_kinds.erase(m_kinds.begin(), m_kinds.begin() + drop);
+    m_flags.erase(m_flags.begin(), m_flags.begin() + drop);
+    m_textStarts.erase(m_textStarts.begin(), m_textStarts.begin() + drop);
+    for (std::uint32_t& start : m_textStarts)
+        start -= arenaStart;
+    m_arena.erase(0, arenaStart);
+    m_first = 0;
+
+    PruneNicks();
+}
+
+void MessageStore::PruneNicks()
+{
+    // Renumber the nicks still in use, in order of first use
+    std::vector<NickId> remap(m_nickNames.size(), NoNick);
+    std::deque<std::string> names{ std::string() };
+    for (NickId& id : m_nicks)
+    {
+        if (id == NoNick)
+            continue;
+        if (remap[id] == NoNick)
+        {
+            remap[id] = static_cast<NickId>(names.size());
+            names.push_back(std::move(m_nickNames[id]));
+        }
+        id = remap[id];
+    }
+
+    m_nickNames.swap(names);
+    m_nickIds.clear();
+    m_nickBytes = 0;
+    for (std::size_t id = 1; id < m_nickNames.size(); ++id)
+    {
+        m_nickIds.emplace(m_nickNames[id], static_cast<NickId>(id));
+        m_nickBytes += NickBytes(m_nickNames[id]);
+    }
+}
+
+std::size_t MessageStore::MemoryUsage() const
+{
+    std::size_t bytes = m_times.capacity() * sizeof(std::int64_t) +
+                        m_nicks.capacity() * sizeof(NickId) +
+                        m_kinds.capacity() * sizeof(MessageKind) +
+                        m_flags.capacity() * sizeof(std::uint8_t) +
+                        m_textStarts.capacity() * sizeof(std::uint32_t) +
+                        m_arena.capacity();
+
+    return bytes + m_nickBytes;
+}
+
+std::size_t MessageStore::MessageBytes(std::size_t index) const
+{
+    return sizeof(std::int64_t) + sizeof(NickId) + sizeof(MessageKind) + sizeof(std::uint8_t) +
+           sizeof(std::uint32_t) + Text(index).size();
+}
+
+std::size_t MessageStore::NickBytes(const std::string& name)
+{
+    // The name (a heap buffer only past the inline capacity) and its lookup
+    // entry: a view, the ID and the hash node's links
+    static const std::size_t inlineCapacity = std::string().capacity();
+    std::size_t bytes = sizeof(std::string) + sizeof(std::string_view) + sizeof(NickId) + 2 * sizeof(void*);
+    if (name.capacity() > inlineCapacity)
+        bytes += name.capacity() + 1;
+    return bytes;
+}
+
+MessageStore::NickId MessageStore::Intern(std::string_view nick)
+{
+    if (nick.empty())
+        return NoNick;
+
+    // Almost every message is from a nick already seen; nothing is copied
+    // for those
+    auto it = m_nickIds.find(nick);
+    if (it != m_nickIds.end())
+        return it->second;
+
+    auto id = static_cast<NickId>(m_nickNames.size());
+    const std::string& name = m_nickNames.emplace_back(nick);
+    m_nickIds.emplace(name, id);
+    m_nickBytes += NickBytes(name);
+    return id;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// What a stored message is; decides how it is rendered
+enum class MessageKind : std::uint8_t
+{
+    Log,     // plain line (server text, joins, parts, ...)
+    System,
+    Error,
+    Chat,
+    Notice,
+    Action,
+    Topic
+};
+
+// -------------------------------------------------------
+// MessageStore
+// The messages behind one log, kept column by column: timestamps, nick IDs,
+// kinds and flags in their own arrays, and all text in one UTF-8 arena.
+// A message costs 18 bytes of columns plus its text, and a scan over one
+// column (say, every highlight) touches nothing else.
+//
+// Old messages are dropped from the front. Indices are relative to the
+// oldest message still held, so they shift when that happens; the dropped
+// prefix is compacted away once it makes up half of the store, together
+// with the nicks no remaining message uses (nick IDs change then too).
+// -------------------------------------------------------
+
+class MessageStore
+{
+public:
+    enum Flags : std::uint8_t
+    {
+        Highlight = 1 << 0,  // mentions our nick
+        Self = 1 << 1        // sent by us
+    };
+
+    using NickId = std::uint32_t;
+    static constexpr NickId NoNick = 0;
+
+    std::size_t Append(std::int64_t time, MessageKind kind, std::uint8_t flags,
+                       std::string_view nick, std::string_view text);
+
+    std::size_t Size() const { return m_times.size() - m_first; }
+    bool Empty() const { return Size() == 0; }
+
+    std::int64_t Time(std::size_t index) const { return m_times[m_first + index]; }
+    MessageKind Kind(std::size_t index) const { return m_kinds[m_first + index]; }
+    std::uint8_t GetFlags(std::size_t index) const { return m_flags[m_first + index]; }
+    NickId Nick(std::size_t index) const { return m_nicks[m_first + index]; }
+    std::string_view NickName(NickId id) const { return m_nickNames[id]; }
+    std::string_view Text(std::size_t index) const;
+
+    // Forget the oldest `count` messages
+    void DropFront(std::size_t count);
+    void Clear();
+
+    // Heap held by the columns, arena and nick table
+    std::size_t MemoryUsage() const;
+
+    // What one message adds to that: its column entries and its text
+    std::size_t MessageBytes(std::size_t index) const;
+
+    // The nick table's share of it, shared by all messages
+    std::size_t NickTableBytes() const { return m_nickBytes; }
+
+private:
+    NickId Intern(std::string_view nick);
+    void Compact();
+    void PruneNicks();
+    static std::size_t NickBytes(const std::string& name);
+
+    // One entry per message, oldest first, from m_first on
+    std::vector<std::int64_t> m_times;        // seconds since the epoch
+    std::vector<NickId> m_nicks;
+    std::vector<MessageKind> m_kinds;
+    std::vector<std::uint8_t> m_flags;
+    std::vector<std::uint32_t> m_textStarts;  // into m_arena; a message ends where the next starts
+    std::size_t m_first = 0;
+
+    std::string m_arena;
+
+    // Nicks used by the messages held; ID 0 is the empty nick. A deque, so
+    // the lookup keys can point into the names as more are added.
+    std::deque<std::string> m_nickNames{ std::string() };
+    std::unordered_map<std::string_view, NickId> m_nickIds;
+    std::size_t m_nickBytes = 0;
+};
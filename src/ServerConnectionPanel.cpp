@@ -1,18 +1,10 @@
 #include "ServerConnectionPanel.h"
 #include "UserProfileDialog.h"
+#include "LogView.h"
 
 #include <wx/frame.h>
 #include <wx/msgdlg.h>
-
-// ---------- Helper: Check if string is a channel name ----------
-
-static bool IsChannelName(const wxString& name)
-{
-    if (name.IsEmpty())
-        return false;
-    wxChar first = name[0];
-    return (first == '#' || first == '&' || first == '!' || first == '+');
-}
+#include <ctime>
 
 // ---------- Helper: Normalize channel name (remove leading colon if present) ----------
 
@@ -28,6 +20,73 @@ static wxString NormalizeChannelName(const wxString& name)
     return result;
 }
 
+// ---------- Helper: Convert a view into a received line to wxString ----------
+
+static wxString ToWxString(std::string_view text)
+{
+    return wxString::FromUTF8(text.data(), text.size());
+}
+
+// Events handled per GUI event-loop iteration
+static constexpr std::size_t MaxEventsPerDrain = 512;
+
+// ---------- Helper: Internal IRCCore chatter that never reaches the console ----------
+
+static bool IsNoisyCoreLog(const std::string& msg)
+{
+    // Checked on the network thread, before anything is converted or queued
+    auto startsWith = [&msg](const char* prefix) { return msg.rfind(prefix, 0) == 0; };
+
+    return startsWith("[Sent]") ||
+           startsWith("[Sending]") ||
+           startsWith("Network thread") ||
+           startsWith("[Auto]");  // PONG replies
+}
+
+// ---------- Helper: Channel types as a mask for the network thread ----------
+
+static std::uint64_t ChannelTypeMask(std::string_view types)
+{
+    // #, &, ! and + are all below 64; a channel of any other type is just
+    // formatted on the GUI thread instead
+    std::uint64_t mask = 0;
+    for (char type : types)
+    {
+        auto c = static_cast<unsigned char>(type);
+        if (c < 64)
+            mask |= std::uint64_t{ 1 } << c;
+    }
+    return mask;
+}
+
+// ---------- Helper: Format channel chat before it reaches the GUI ----------
+
+static std::shared_ptr<const FormattedText> PreformatChat(const IrcMessage& msg, std::uint64_t channelTypes,
+                                                          const IrcCaseFold& fold, std::string_view ownNickKey)
+{
+    // Runs on the network thread for every line, so it bails out early on
+    // anything but channel PRIVMSGs (CTCP ACTIONs are drawn unformatted)
+    if (msg.commandId != IrcCommand::Privmsg || msg.paramCount < 2)
+        return nullptr;
+
+    std::string_view target = msg.param(0);
+    if (!target.empty() && target.front() == ':')
+        target.remove_prefix(1);
+    std::string_view text = msg.param(1);
+    unsigned first = target.empty() ? 64 : static_cast<unsigned char>(target.front());
+    if (first >= 64 || !(channelTypes & (std::uint64_t{ 1 } << first)) ||
+        (!text.empty() && text.front() == '\001'))
+        return nullptr;
+
+    auto formatted = std::make_shared<FormattedText>();
+    formatted->time = static_cast<std::int64_t>(std::time(nullptr));
+    formatted->text.assign(text);
+    AppendIrcFormattedText(formatted->body, text);
+    formatted->highlight = !ownNickKey.empty() && !fold.equal(msg.nick, ownNickKey) &&
+                           fold.contains(text, ownNickKey);
+    return formatted;
+}
+
 // ---------- ctor / dtor ----------
 
 ServerConnectionPanel::ServerConnectionPanel(wxWindow* parent,
@@ -86,32 +145,52 @@ ServerConnectionPanel::ServerConnectionPanel(wxWindow* parent,
     m_btnSend->Bind(wxEVT_BUTTON, &ServerConnectionPanel::OnSend, this);
     m_input->Bind(wxEVT_KEY_DOWN, &ServerConnectionPanel::OnInputKeyDown, this);
 
-    // IRCCore callbacks - use CallAfter to marshal to GUI thread
-    m_core.setLogCallback([this](const std::string& msg) {
-        wxString wxMsg = wxString::FromUTF8(msg.c_str());
-        CallAfter([this, wxMsg]() { HandleCoreLog(wxMsg); });
-    });
+    UpdateNickKey();
 
-    m_core.setMessageCallback([this](const std::string& source,
-                                     const std::string& text) {
-        wxString wxSrc = wxString::FromUTF8(source.c_str());
-        wxString wxText = wxString::FromUTF8(text.c_str());
-        CallAfter([this, wxSrc, wxText]() { HandleCoreMessage(wxSrc, wxText); });
+    // IRCCore callbacks run on network threads. They only queue events;
+    // the GUI drains the queue once per event-loop iteration, however many
+    // lines arrived in between.
+    m_core.setLogCallback([this](const std::string& msg) {
+        if (IsNoisyCoreLog(msg))
+            return;
+        IrcEvent event;
+        event.type = IrcEvent::Type::Log;
+        event.text = msg;
+        QueueCoreEvent(std::move(event));
     });
 
-    m_core.setRawLineCallback([this](const std::string& line) {
-        wxString wxLine = wxString::FromUTF8(line.c_str());
-        CallAfter([this, wxLine]() { HandleRawLine(wxLine); });
+    m_core.setRawLineCallback([this](const IrcMessage& msg) {
+        // The message's views die with the network buffer; IrcLine keeps a
+        // copy of the line without parsing it again
+        IrcEvent event;
+        event.type = IrcEvent::Type::Line;
+        event.line = IrcLine(msg);
+
+        // Do the per-line formatting and highlight test here rather than
+        // on the GUI thread
+        std::shared_ptr<const OwnNick> ownNick = std::atomic_load(&m_ownNick);
+        event.formatted = PreformatChat(msg, m_channelTypeMask.load(std::memory_order_relaxed),
+                                        ownNick->fold, ownNick->key);
+        QueueCoreEvent(std::move(event));
     });
 
     m_core.setDisconnectCallback([this]() {
-        CallAfter([this]() { HandleDisconnect(); });
+        IrcEvent event;
+        event.type = IrcEvent::Type::Disconnected;
+        QueueCoreEvent(std::move(event));
     });
 
     m_core.setWhoisCallback([this](const UserInfo& userInfo) {
-        CallAfter([this, userInfo]() { HandleWhois(userInfo); });
+        IrcEvent event;
+        event.type = IrcEvent::Type::Whois;
+        event.whois = std::make_shared<UserInfo>(userInfo);
+        QueueCoreEvent(std::move(event));
     });
 
+    // Stop reading from the server while the event ring is full; the GUI
+    // resumes it after each drain
+    m_core.setReceiveGate([this]() { return m_coreEvents.hasRoom(); });
+
     // Bind reconnect timer
     m_reconnectTimer.Bind(wxEVT_TIMER, &ServerConnectionPanel::OnReconnectTimer, this);
 
@@ -138,6 +217,16 @@ ServerConnectionPanel::~ServerConnectionPanel()
     m_core.setDisconnectCallback(nullptr);
 
     m_core.disconnect();
+
+    // The pages' member lists and nick lists refer to m_users, which is
+    // destroyed with the members below; ~wxWindow would only destroy the
+    // pages after that
+    DestroyChildren();
+    m_consoleView = nullptr;
+    m_viewBook = nullptr;
+    m_input = nullptr;
+    m_btnSend = nullptr;
+    m_channels.clear();
 }
 
 // ---------- public helpers ----------
@@ -189,6 +278,9 @@ void ServerConnectionPanel::ApplySettings(const AppSettings& settings)
 {
     m_settings = settings;
 
+    // New rate limits apply to the live connection too
+    m_core.setFloodControl(m_settings.floodControlFor(std::string(m_server.ToUTF8())));
+
     // Apply to console
     if (m_consoleView)
         m_consoleView->SetSettings(&m_settings);
@@ -200,6 +292,23 @@ void ServerConnectionPanel::ApplySettings(const AppSettings& settings)
     }
 }
 
+std::size_t ServerConnectionPanel::GetScrollbackBytes() const
+{
+    std::size_t bytes = m_consoleView ? m_consoleView->GetScrollbackBytes() : 0;
+    for (const auto& [name, page] : m_channels)
+        bytes += page->GetScrollbackBytes();
+    return bytes;
+}
+
+void ServerConnectionPanel::SetShown(bool shown)
+{
+    if (shown == m_shown)
+        return;
+
+    m_shown = shown;
+    UpdateActivePage();
+}
+
 void ServerConnectionPanel::FocusInput()
 {
     if (m_input)
@@ -222,6 +331,12 @@ void ServerConnectionPanel::ConnectCore()
     long portVal = 6667;
     m_port.ToLong(&portVal);
 
+    // A new server announces its own casemapping, prefixes and channel types
+    m_isupport.reset();
+    ApplyISupport();
+    m_pendingNames.clear();
+
+    m_core.setFloodControl(m_settings.floodControlFor(std::string(m_server.ToUTF8())));
     m_core.connectToServer(
         std::string(m_server.ToUTF8()),
         static_cast<int>(portVal),
@@ -229,394 +344,576 @@ void ServerConnectionPanel::ConnectCore()
         std::string(m_password.ToUTF8()));
 }
 
+std::string ServerConnectionPanel::ChannelKey(std::string_view channelName) const
+{
+    return m_isupport.caseFold().fold(channelName);
+}
+
+std::string ServerConnectionPanel::ChannelKey(const wxString& channelName) const
+{
+    wxScopedCharBuffer utf8 = channelName.ToUTF8();
+    return ChannelKey(std::string_view(utf8.data(), utf8.length()));
+}
+
+ChannelPage* ServerConnectionPanel::FindChannelPage(std::string_view channelName) const
+{
+    auto it = m_channels.find(ChannelKey(channelName));
+    return it != m_channels.end() ? it->second : nullptr;
+}
+
 ChannelPage* ServerConnectionPanel::GetOrCreateChannelPage(const wxString& channelName)
 {
-    auto it = m_channels.find(channelName);
+    // "#Foo" and "#foo" are the same channel; the tab keeps the first spelling
+    std::string key = ChannelKey(channelName);
+    auto it = m_channels.find(key);
     if (it != m_channels.end())
         return it->second;
 
     // Create new channel page
-    auto* page = new ChannelPage(m_viewBook, channelName, &m_settings, this);
+    auto* page = new ChannelPage(m_viewBook, channelName, m_users, &m_settings, this);
+    page->GetMembers().SetPrefixSymbols(m_isupport.prefixSymbols());
     m_viewBook->AddPage(page, channelName, true);
 
-    m_channels[channelName] = page;
+    m_channels.emplace(std::move(key), page);
+    UpdateActivePage();
     return page;
 }
 
-// ---------- IRCCore callbacks ----------
+bool ServerConnectionPanel::IsChannelName(const wxString& name) const
+{
+    // Channel types are ASCII
+    if (name.IsEmpty() || name[0] >= 0x80)
+        return false;
 
-void ServerConnectionPanel::HandleCoreLog(const wxString& msg)
+    char first = static_cast<char>(name[0]);
+    return m_isupport.isChannel(std::string_view(&first, 1));
+}
+
+wxString ServerConnectionPanel::ChannelNameAt(int pageIndex) const
 {
-    // Filter out noisy/internal messages
-    if (msg.StartsWith("[Sent]"))
-        return;
-    if (msg.StartsWith("[Sending]"))
-        return;
-    if (msg.StartsWith("Network thread"))
-        return;
-    if (msg.StartsWith("[Auto]"))  // PONG replies
+    // Tab titles carry unread counts, so names come from the pages
+    if (pageIndex <= 0 || static_cast<size_t>(pageIndex) >= m_viewBook->GetPageCount())
+        return wxEmptyString;
+
+    auto* page = dynamic_cast<ChannelPage*>(m_viewBook->GetPage(static_cast<size_t>(pageIndex)));
+    return page ? page->GetChannelName() : wxString();
+}
+
+void ServerConnectionPanel::UpdateActivePage()
+{
+    if (m_isDestroying)
         return;
 
-    // Update status bar for connection events
-    if (msg.StartsWith("Connected to ") || msg.StartsWith("Connecting to "))
+    // Only the page on screen renders as messages arrive; the rest record
+    // them and catch up when selected
+    int sel = m_viewBook->GetSelection();
+    for (size_t i = 0; i < m_viewBook->GetPageCount(); ++i)
     {
-        wxFrame* frame = wxDynamicCast(wxGetTopLevelParent(this), wxFrame);
-        if (frame)
-            frame->SetStatusText(msg);
+        bool active = m_shown && static_cast<int>(i) == sel;
+        wxWindow* page = m_viewBook->GetPage(i);
+        if (page == m_consoleView)
+            m_consoleView->SetActive(active);
+        else if (auto* channel = dynamic_cast<ChannelPage*>(page))
+            channel->SetActive(active);
     }
 
-    LogToConsole(msg);
+    UpdateUnreadTitles();
 }
 
-void ServerConnectionPanel::HandleCoreMessage(const wxString& /*source*/,
-    const wxString& /*text*/)
+void ServerConnectionPanel::UpdateUnreadTitles()
 {
-    // Don't log here - messages are handled in HandleRawLine for channels
-    // and this would cause duplicates
+    for (size_t i = 1; i < m_viewBook->GetPageCount(); ++i)
+    {
+        auto* channel = dynamic_cast<ChannelPage*>(m_viewBook->GetPage(i));
+        if (!channel)
+            continue;
+
+        wxString title = channel->GetChannelName();
+        if (std::size_t unread = channel->GetUnreadCount())
+            title += wxString::Format(" (%lu)", static_cast<unsigned long>(unread));
+        if (m_viewBook->GetPageText(i) != title)
+            m_viewBook->SetPageText(i, title);
+    }
 }
 
+// ---------- IRCCore callbacks ----------
 
-// ---------- RAW LINE HANDLER ----------
-
-void ServerConnectionPanel::HandleRawLine(const wxString& line)
+void ServerConnectionPanel::QueueCoreEvent(IrcEvent event)
 {
-    // Parse IRC message: [:prefix] command [params] [:trailing]
-    wxString prefix, command, params, trailing;
-    wxString rest = line;
+    // Network threads: only the first event after a drain posts to the GUI
+    if (m_coreEvents.push(std::move(event)))
+        CallAfter([this]() { DrainCoreEvents(); });
+}
 
-    // Extract prefix (starts with :)
-    if (rest.StartsWith(":"))
+void ServerConnectionPanel::DrainCoreEvents()
+{
+    // Work on a local batch so a nested event loop (e.g. a dialog) that
+    // drains again cannot touch the vector being walked
+    std::vector<IrcEvent> batch = std::move(m_eventBatch);
+    bool more = m_coreEvents.drain(batch, MaxEventsPerDrain);
+
+    // Let the network side refill the ring while we work through the batch,
+    // and come back for the rest on the next event-loop iteration so input
+    // and painting stay responsive during a flood
+    m_core.resumeReceiving();
+    if (more)
+        CallAfter([this]() { DrainCoreEvents(); });
+
+    for (const IrcEvent& event : batch)
     {
-        rest = rest.Mid(1);
-        prefix = rest.BeforeFirst(' ');
-        rest = rest.AfterFirst(' ');
+        if (m_isDestroying)
+            break;
+
+        switch (event.type)
+        {
+        case IrcEvent::Type::Line:
+            m_preformatted = std::move(event.formatted);
+            HandleRawLine(event.line.message());
+            m_preformatted.reset();
+            break;
+        case IrcEvent::Type::Log:
+            HandleCoreLog(wxString::FromUTF8(event.text.data(), event.text.size()));
+            break;
+        case IrcEvent::Type::Whois:
+            HandleWhois(*event.whois);
+            break;
+        case IrcEvent::Type::Disconnected:
+            HandleDisconnect();
+            break;
+        }
     }
 
-    // Extract command
-    command = rest.BeforeFirst(' ');
-    rest = rest.AfterFirst(' ');
+    // Keep the buffer for the next drain
+    batch.clear();
+    m_eventBatch = std::move(batch);
 
-    // Extract trailing (after " :")
-    if (rest.Contains(" :"))
+    // Tab titles change once per batch, not once per message
+    UpdateUnreadTitles();
+}
+
+void ServerConnectionPanel::HandleCoreLog(const wxString& msg)
+{
+    // Update status bar for connection events
+    if (msg.StartsWith("Connected to ") || msg.StartsWith("Connecting to "))
     {
-        params = rest.BeforeFirst(':');
-        trailing = rest.AfterFirst(':');
+        wxFrame* frame = wxDynamicCast(wxGetTopLevelParent(this), wxFrame);
+        if (frame)
+            frame->SetStatusText(msg);
     }
-    else
+
+    LogToConsole(msg);
+}
+
+
+// ---------- RAW LINE HANDLER ----------
+
+void ServerConnectionPanel::HandleRawLine(const IrcMessage& msg)
+{
+    // The command was resolved to an ID on the network thread; this is one
+    // table lookup no matter how many handlers exist
+    static constexpr auto handlers = [] {
+        std::array<RawLineHandler, IrcCommandCount> table{};
+        table[ircCommandIndex(IrcCommand::Privmsg)] = &ServerConnectionPanel::HandlePrivmsg;
+        table[ircCommandIndex(IrcCommand::Notice)] = &ServerConnectionPanel::HandleNotice;
+        table[ircCommandIndex(IrcCommand::Join)] = &ServerConnectionPanel::HandleJoin;
+        table[ircCommandIndex(IrcCommand::Part)] = &ServerConnectionPanel::HandlePart;
+        table[ircCommandIndex(IrcCommand::Quit)] = &ServerConnectionPanel::HandleQuit;
+        table[ircCommandIndex(IrcCommand::Kick)] = &ServerConnectionPanel::HandleKick;
+        table[ircCommandIndex(IrcCommand::Nick)] = &ServerConnectionPanel::HandleNick;
+        table[ircCommandIndex(IrcCommand::Topic)] = &ServerConnectionPanel::HandleTopic;
+        table[ircCommandIndex(IrcCommand::RplTopic)] = &ServerConnectionPanel::HandleTopicReply;
+        table[ircCommandIndex(IrcCommand::RplNamReply)] = &ServerConnectionPanel::HandleNamesReply;
+        table[ircCommandIndex(IrcCommand::RplEndOfNames)] = &ServerConnectionPanel::HandleEndOfNames;
+        table[ircCommandIndex(IrcCommand::ErrNicknameInUse)] = &ServerConnectionPanel::HandleNickInUse;
+        table[ircCommandIndex(IrcCommand::RplWelcome)] = &ServerConnectionPanel::HandleWelcome;
+        table[ircCommandIndex(IrcCommand::RplYourHost)] = &ServerConnectionPanel::HandleServerText;
+        table[ircCommandIndex(IrcCommand::RplCreated)] = &ServerConnectionPanel::HandleServerText;
+        table[ircCommandIndex(IrcCommand::RplMyInfo)] = &ServerConnectionPanel::HandleServerText;
+        table[ircCommandIndex(IrcCommand::RplMotd)] = &ServerConnectionPanel::HandleServerText;
+        table[ircCommandIndex(IrcCommand::RplMotdStart)] = &ServerConnectionPanel::HandleServerText;
+        table[ircCommandIndex(IrcCommand::RplEndOfMotd)] = &ServerConnectionPanel::HandleServerText;
+        // Server features (005) and "no topic" (331) are hidden from the user
+        table[ircCommandIndex(IrcCommand::RplISupport)] = &ServerConnectionPanel::HandleISupport;
+        table[ircCommandIndex(IrcCommand::RplNoTopic)] = &ServerConnectionPanel::HandleIgnored;
+        return table;
+    }();
+
+    RawLineHandler handler = handlers[ircCommandIndex(msg.commandId)];
+    if (handler)
     {
-        params = rest;
+        (this->*handler)(msg);
+        return;
     }
 
-    params = params.Trim(true).Trim(false);
+    // ---------- Default: show in console ----------
+    LogToConsole("<< " + ToWxString(msg.raw));
+}
 
-    // Split params by space
-    auto words = wxSplit(params, ' ');
+// ---------- PRIVMSG ----------
 
-    // Helper to extract nick from prefix (nick!user@host)
-    auto getNick = [](const wxString& pfx) -> wxString {
-        if (pfx.Contains("!"))
-            return pfx.BeforeFirst('!');
-        return pfx;
-    };
+void ServerConnectionPanel::HandlePrivmsg(const IrcMessage& msg)
+{
+    if (msg.paramCount < 1)
+        return;
 
-    // Helper to append to a channel's log
-    auto appendToChan = [this](const wxString& chan, const wxString& text) {
-        ChannelPage* page = GetOrCreateChannelPage(chan);
-        page->AppendLog(text);
-    };
+    wxString target = NormalizeChannelName(ToWxString(msg.param(0)));
+    wxString nick = ToWxString(msg.nick);
 
-    // ---------- PRIVMSG ----------
-    if (command == "PRIVMSG" && !words.empty())
+    // Channel chat formatted on the network thread: nothing left to convert
+    if (m_preformatted && IsChannelName(target))
     {
-        wxString target = NormalizeChannelName(words[0]);
-        wxString nick = getNick(prefix);
-
-        if (IsChannelName(target))
-        {
-            ChannelPage* page = GetOrCreateChannelPage(target);
-
-            // Check for CTCP ACTION (/me command)
-            if (trailing.StartsWith("\001ACTION ") && trailing.EndsWith("\001"))
-            {
-                wxString action = trailing.Mid(8);  // Skip "\001ACTION "
-                action = action.Left(action.Length() - 1);  // Remove trailing \001
-                page->AppendAction(nick, action);
-            }
-            else
-            {
-                page->AppendChatMessage(nick, trailing);
-            }
-        }
-        else
-        {
-            // Private message to us
-            LogToConsole("[PM from " + nick + "] " + trailing);
-        }
+        ChannelPage* page = GetOrCreateChannelPage(target);
+        page->GetMembers().Spoke(msg.nick);
+        page->AppendChatMessage(nick, m_preformatted);
         return;
     }
 
-    // ---------- NOTICE ----------
-    if (command == "NOTICE" && !words.empty())
+    wxString text = ToWxString(msg.param(1));
+
+    if (IsChannelName(target))
     {
-        wxString target = NormalizeChannelName(words[0]);
-        wxString nick = getNick(prefix);
+        ChannelPage* page = GetOrCreateChannelPage(target);
+        page->GetMembers().Spoke(msg.nick);
 
-        if (IsChannelName(target))
+        // Check for CTCP ACTION (/me command)
+        if (text.StartsWith("\001ACTION ") && text.EndsWith("\001"))
         {
-            ChannelPage* page = GetOrCreateChannelPage(target);
-            page->AppendNotice(nick, trailing);
+            wxString action = text.Mid(8);  // Skip "\001ACTION "
+            action = action.Left(action.Length() - 1);  // Remove trailing \001
+            page->AppendAction(nick, action);
         }
         else
         {
-            LogToConsole("-" + nick + "- " + trailing);
+            page->AppendChatMessage(nick, text);
         }
-        return;
     }
-
-    // ---------- JOIN ----------
-    if (command == "JOIN")
+    else
     {
-        wxString nick = getNick(prefix);
-        wxString chan = trailing.IsEmpty() ? params : trailing;
-        chan = NormalizeChannelName(chan);
+        // Private message to us
+        LogToConsole("[PM from " + nick + "] " + text);
+    }
+}
 
-        ChannelPage* page = GetOrCreateChannelPage(chan);
+// ---------- NOTICE ----------
 
-        if (nick == m_nick)
-        {
-            // We joined - switch to the new tab
-            int idx = m_viewBook->FindPage(page);
-            if (idx != wxNOT_FOUND)
-            {
-                m_viewBook->SetSelection(idx);
-                UpdateWindowTitle();
-                // Focus input when we join a channel
-                FocusInput();
-            }
-        }
+void ServerConnectionPanel::HandleNotice(const IrcMessage& msg)
+{
+    if (msg.paramCount < 1)
+        return;
 
-        page->AppendLog(nick + " has joined " + chan);
-        
-        // Add nick to the list if not already present
-        wxListBox* nickList = page->GetNickList();
-        if (nickList->FindString(nick) == wxNOT_FOUND)
-            nickList->Append(nick);
+    wxString target = NormalizeChannelName(ToWxString(msg.param(0)));
+    wxString nick = ToWxString(msg.nick);
+    wxString text = ToWxString(msg.param(1));
 
-        return;
+    if (IsChannelName(target))
+    {
+        ChannelPage* page = GetOrCreateChannelPage(target);
+        page->AppendNotice(nick, text);
     }
-
-    // ---------- PART ----------
-    if (command == "PART" && !words.empty())
+    else
     {
-        wxString chan = NormalizeChannelName(words[0]);
-        wxString nick = getNick(prefix);
+        LogToConsole("-" + nick + "- " + text);
+    }
+}
 
-        auto it = m_channels.find(chan);
-        if (it != m_channels.end())
-        {
-            ChannelPage* page = it->second;
-            wxString reason = trailing.IsEmpty() ? "" : " (" + trailing + ")";
-            page->AppendLog(nick + " has left " + chan + reason);
+// ---------- JOIN ----------
 
-            int idx = page->GetNickList()->FindString(nick);
-            if (idx != wxNOT_FOUND)
-                page->GetNickList()->Delete(idx);
-        }
-        return;
-    }
+void ServerConnectionPanel::HandleJoin(const IrcMessage& msg)
+{
+    wxString nick = ToWxString(msg.nick);
+    wxString chan = NormalizeChannelName(ToWxString(msg.param(0)));
 
-    // ---------- QUIT ----------
-    if (command == "QUIT")
-    {
-        wxString nick = getNick(prefix);
-        wxString reason = trailing.IsEmpty() ? "Quit" : trailing;
+    ChannelPage* page = GetOrCreateChannelPage(chan);
 
-        for (auto& [chanName, page] : m_channels)
+    if (IsOwnNick(msg.nick))
+    {
+        // We joined - switch to the new tab
+        int idx = m_viewBook->FindPage(page);
+        if (idx != wxNOT_FOUND)
         {
-            int idx = page->GetNickList()->FindString(nick);
-            if (idx != wxNOT_FOUND)
-            {
-                page->AppendLog(nick + " has quit (" + reason + ")");
-                page->GetNickList()->Delete(idx);
-            }
+            m_viewBook->SetSelection(idx);
+            UpdateWindowTitle();
+            // Focus input when we join a channel
+            FocusInput();
         }
-        return;
     }
 
-    // ---------- KICK ----------
-    if (command == "KICK" && words.size() >= 2)
+    page->AppendLog(nick + " has joined " + chan);
+
+    if (UserRegistry::UserId id = page->GetMembers().Add(msg.nick))
     {
-        wxString chan = NormalizeChannelName(words[0]);
-        wxString kicked = words[1];
-        wxString kicker = getNick(prefix);
-        wxString reason = trailing.IsEmpty() ? kicked : trailing;
+        m_users.SetAddress(id, msg.user, msg.host);
+        page->MembersChanged();
+    }
+}
 
-        auto it = m_channels.find(chan);
-        if (it != m_channels.end())
-        {
-            ChannelPage* page = it->second;
-            page->AppendLog(kicked + " was kicked by " + kicker + " (" + reason + ")");
+// ---------- PART ----------
 
-            int idx = page->GetNickList()->FindString(kicked);
-            if (idx != wxNOT_FOUND)
-                page->GetNickList()->Delete(idx);
-        }
+void ServerConnectionPanel::HandlePart(const IrcMessage& msg)
+{
+    if (msg.paramCount < 1)
         return;
-    }
 
-    // ---------- NICK CHANGE ----------
-    if (command == "NICK")
+    wxString chan = NormalizeChannelName(ToWxString(msg.param(0)));
+    wxString nick = ToWxString(msg.nick);
+
+    auto it = m_channels.find(ChannelKey(chan));
+    if (it != m_channels.end())
     {
-        wxString oldNick = getNick(prefix);
-        
-        // New nick can be in trailing (after :) or in params
-        wxString newNick = trailing;
-        if (newNick.IsEmpty())
-            newNick = params;
-        newNick.Trim(true).Trim(false);
-        
-        // Remove leading colon if present
-        if (newNick.StartsWith(":"))
-            newNick = newNick.Mid(1);
+        ChannelPage* page = it->second;
+        wxString partMessage = ToWxString(msg.param(1));
+        wxString reason = partMessage.IsEmpty() ? "" : " (" + partMessage + ")";
+        page->AppendLog(nick + " has left " + chan + reason);
 
-        if (newNick.IsEmpty())
-        {
-            LogToConsole("*** Error parsing NICK change");
-            return;
-        }
+        if (page->GetMembers().Remove(msg.nick))
+            page->MembersChanged();
+    }
+}
 
-        // Update nick in all channels
-        for (auto& [chanName, page] : m_channels)
-        {
-            int idx = page->GetNickList()->FindString(oldNick);
-            if (idx != wxNOT_FOUND)
-            {
-                page->GetNickList()->Delete(idx);
-                page->GetNickList()->Append(newNick);
-                page->AppendLog(oldNick + " is now known as " + newNick);
-            }
-        }
+// ---------- QUIT ----------
 
-        // Update our own nick if it changed
-        if (oldNick == m_nick)
-        {
-            m_nick = newNick;
-            if (m_viewBook)
-                m_viewBook->SetPageText(0, BuildConsoleTabTitle());
+void ServerConnectionPanel::HandleQuit(const IrcMessage& msg)
+{
+    wxString nick = ToWxString(msg.nick);
+    wxString reason = msg.param(0).empty() ? wxString("Quit") : ToWxString(msg.param(0));
 
-            LogToConsole("You are now known as " + newNick);
-            UpdateWindowTitle();
-        }
+    UserRegistry::UserId id = m_users.Find(msg.nick);
+    if (id == UserRegistry::NoUser)
         return;
-    }
 
-    // ---------- TOPIC ----------
-    if (command == "TOPIC" && !words.empty())
-    {
-        wxString chan = NormalizeChannelName(words[0]);
-        wxString nick = getNick(prefix);
+    // Only the channels the user was in
+    std::vector<UserRegistry::Membership> channels = m_users.Get(id).channels;
+    m_users.Remove(id);
 
-        auto it = m_channels.find(chan);
-        if (it != m_channels.end())
+    for (const UserRegistry::Membership& membership : channels)
+    {
+        if (ChannelPage* page = FindChannelPage(membership.channel->Name()))
         {
-            it->second->AppendLog(nick + " changed topic to: " + trailing);
+            page->AppendLog(nick + " has quit (" + reason + ")");
+            page->MembersChanged();
         }
+    }
+}
+
+// ---------- KICK ----------
+
+void ServerConnectionPanel::HandleKick(const IrcMessage& msg)
+{
+    if (msg.paramCount < 2)
         return;
+
+    wxString chan = NormalizeChannelName(ToWxString(msg.param(0)));
+    wxString kicked = ToWxString(msg.param(1));
+    wxString kicker = ToWxString(msg.nick);
+    wxString reason = msg.param(2).empty() ? kicked : ToWxString(msg.param(2));
+
+    auto it = m_channels.find(ChannelKey(chan));
+    if (it != m_channels.end())
+    {
+        ChannelPage* page = it->second;
+        page->AppendLog(kicked + " was kicked by " + kicker + " (" + reason + ")");
+
+        if (page->GetMembers().Remove(msg.param(1)))
+            page->MembersChanged();
     }
+}
+
+// ---------- NICK CHANGE ----------
+
+void ServerConnectionPanel::HandleNick(const IrcMessage& msg)
+{
+    wxString oldNick = ToWxString(msg.nick);
 
-    // ---------- 332 (RPL_TOPIC) ----------
-    if (command == "332" && words.size() >= 2)
+    // New nick is the only parameter, with or without a leading colon
+    wxString newNick = ToWxString(msg.param(0));
+    newNick.Trim(true).Trim(false);
+
+    if (newNick.IsEmpty())
     {
-        wxString chan = NormalizeChannelName(words[1]);
-        auto it = m_channels.find(chan);
-        if (it != m_channels.end())
-        {
-            it->second->AppendLog("Topic: " + trailing);
-        }
+        LogToConsole("*** Error parsing NICK change");
         return;
     }
 
-    // ---------- 353 (RPL_NAMREPLY) ----------
-    if (command == "353" && words.size() >= 3)
+    // Update nick in the channels the user is in
+    UserRegistry::UserId id = m_users.Find(msg.nick);
+    if (id != UserRegistry::NoUser)
     {
-        wxString chan = NormalizeChannelName(words[2]);
-        wxArrayString nicks = wxSplit(trailing, ' ');
+        wxScopedCharBuffer newNickUtf8 = newNick.ToUTF8();
+        m_users.Rename(id, std::string_view(newNickUtf8.data(), newNickUtf8.length()));
 
-        ChannelPage* page = GetOrCreateChannelPage(chan);
-        page->GetNickList()->Clear();
-
-        for (auto& n : nicks)
+        for (const UserRegistry::Membership& membership : m_users.Get(id).channels)
         {
-            // Strip mode prefixes (@, +, %, etc.)
-            while (!n.IsEmpty() && (n[0] == '@' || n[0] == '+' || 
-                                    n[0] == '%' || n[0] == '~' || n[0] == '&'))
+            if (ChannelPage* page = FindChannelPage(membership.channel->Name()))
             {
-                n = n.Mid(1);
+                page->AppendLog(oldNick + " is now known as " + newNick);
+                page->MembersChanged();
             }
-            if (!n.IsEmpty())
-                page->GetNickList()->Append(n);
         }
-        return;
     }
 
-    // ---------- 366 (RPL_ENDOFNAMES) ----------
-    if (command == "366" && words.size() >= 2)
+    // Update our own nick if it changed; the server may have changed only
+    // its case
+    if (IsOwnNick(msg.nick))
     {
-        wxString chan = NormalizeChannelName(words[1]);
-        auto it = m_channels.find(chan);
-        if (it != m_channels.end())
-        {
-            it->second->AppendLog("--- End of NAMES list ---");
-        }
-        return;
+        m_nick = newNick;
+        UpdateNickKey();
+        if (m_viewBook)
+            m_viewBook->SetPageText(0, BuildConsoleTabTitle());
+
+        LogToConsole("You are now known as " + newNick);
+        UpdateWindowTitle();
     }
+}
 
-    // ---------- 433 (ERR_NICKNAMEINUSE) ----------
-    if (command == "433")
-    {
-        LogToConsole("*** Nickname is already in use. Try /nick <newnick>");
+// ---------- TOPIC ----------
+
+void ServerConnectionPanel::HandleTopic(const IrcMessage& msg)
+{
+    if (msg.paramCount < 1)
         return;
-    }
 
-    // ---------- 005 (RPL_ISUPPORT) - Server features, hide from user ----------
-    if (command == "005")
+    wxString chan = NormalizeChannelName(ToWxString(msg.param(0)));
+    wxString nick = ToWxString(msg.nick);
+
+    auto it = m_channels.find(ChannelKey(chan));
+    if (it != m_channels.end())
     {
-        return;
+        it->second->AppendLog(nick + " changed topic to: " + ToWxString(msg.param(1)));
     }
+}
 
-    // ---------- 331 (RPL_NOTOPIC) - No topic set, hide from user ----------
-    if (command == "331")
-    {
+// ---------- 332 (RPL_TOPIC) ----------
+
+void ServerConnectionPanel::HandleTopicReply(const IrcMessage& msg)
+{
+    if (msg.paramCount < 2)
         return;
+
+    wxString chan = NormalizeChannelName(ToWxString(msg.param(1)));
+    auto it = m_channels.find(ChannelKey(chan));
+    if (it != m_channels.end())
+    {
+        it->second->AppendLog("Topic: " + ToWxString(msg.trailing()));
     }
+}
+
+// ---------- 353 (RPL_NAMREPLY) ----------
+
+void ServerConnectionPanel::HandleNamesReply(const IrcMessage& msg)
+{
+    if (msg.paramCount < 3)
+        return;
 
-    // ---------- Welcome messages (001-004) ----------
-    if (command == "001" || command == "002" || command == "003" || command == "004")
+    wxString chan = NormalizeChannelName(ToWxString(msg.param(2)));
+    GetOrCreateChannelPage(chan);
+
+    // A big channel's list spans dozens of replies; gather them and load
+    // the whole list at the 366
+    std::string& names = m_pendingNames[ChannelKey(chan)];
+    if (!names.empty())
+        names += ' ';
+    names += msg.trailing();
+}
+
+// ---------- 366 (RPL_ENDOFNAMES) ----------
+
+void ServerConnectionPanel::HandleEndOfNames(const IrcMessage& msg)
+{
+    if (msg.paramCount < 2)
+        return;
+
+    wxString chan = NormalizeChannelName(ToWxString(msg.param(1)));
+    std::string key = ChannelKey(chan);
+    auto names = m_pendingNames.find(key);
+    auto it = m_channels.find(key);
+    if (it != m_channels.end())
     {
-        LogToConsole(trailing);
-        
-        // Update status bar on successful connect (001)
-        if (command == "001")
+        // One sort of the members and one nick list refresh for the burst
+        if (names != m_pendingNames.end())
         {
-            wxFrame* frame = wxDynamicCast(wxGetTopLevelParent(this), wxFrame);
-            if (frame)
-                frame->SetStatusText("Connected to " + m_server + " as " + m_nick);
-
-            // Reset reconnect attempts on successful connection
-            m_reconnectAttempts = 0;
+            it->second->GetMembers().Assign(names->second);
+            it->second->MembersChanged();
         }
-        return;
+        it->second->AppendLog("--- End of NAMES list ---");
     }
 
-    // ---------- MOTD lines ----------
-    if (command == "372" || command == "375" || command == "376")
+    if (names != m_pendingNames.end())
+        m_pendingNames.erase(names);
+}
+
+// ---------- 433 (ERR_NICKNAMEINUSE) ----------
+
+void ServerConnectionPanel::HandleNickInUse(const IrcMessage&)
+{
+    LogToConsole("*** Nickname is already in use. Try /nick <newnick>");
+}
+
+// ---------- 001 (RPL_WELCOME) ----------
+
+void ServerConnectionPanel::HandleWelcome(const IrcMessage& msg)
+{
+    HandleServerText(msg);
+
+    // Update status bar on successful connect
+    wxFrame* frame = wxDynamicCast(wxGetTopLevelParent(this), wxFrame);
+    if (frame)
+        frame->SetStatusText("Connected to " + m_server + " as " + m_nick);
+
+    // Reset reconnect attempts on successful connection
+    m_reconnectAttempts = 0;
+}
+
+// ---------- Welcome (002-004) and MOTD lines ----------
+
+void ServerConnectionPanel::HandleServerText(const IrcMessage& msg)
+{
+    LogToConsole(ToWxString(msg.trailing()));
+}
+
+void ServerConnectionPanel::HandleIgnored(const IrcMessage&)
+{
+}
+
+// ---------- 005 (RPL_ISUPPORT) ----------
+
+void ServerConnectionPanel::HandleISupport(const IrcMessage& msg)
+{
+    // Servers send several of these; act only on those that change something
+    if (m_isupport.apply(msg))
+        ApplyISupport();
+}
+
+void ServerConnectionPanel::ApplyISupport()
+{
+    m_channelTypeMask.store(ChannelTypeMask(m_isupport.channelTypes()), std::memory_order_relaxed);
+    m_users.SetCaseFold(m_isupport.caseFold());
+    UpdateNickKey();
+
+    // Re-key the open channels, and the NAMES gathered for them so far (a
+    // 005 can arrive between a 353 and its 366). Tabs whose names now
+    // fold together stay open, but only the first is looked up.
+    std::unordered_map<std::string, ChannelPage*> channels;
+    std::unordered_map<std::string, std::string> pendingNames;
+    for (const auto& [key, page] : m_channels)
     {
-        LogToConsole(trailing);
-        return;
+        page->GetMembers().SetPrefixSymbols(m_isupport.prefixSymbols());
+        std::string newKey = ChannelKey(page->GetChannelName());
+
+        auto names = m_pendingNames.find(key);
+        if (names != m_pendingNames.end())
+            pendingNames.emplace(newKey, std::move(names->second));
+        channels.emplace(std::move(newKey), page);
     }
+    m_channels.swap(channels);
+    m_pendingNames.swap(pendingNames);
+}
 
-    // ---------- Default: show in console ----------
-    LogToConsole("<< " + line);
+void ServerConnectionPanel::UpdateNickKey()
+{
+    // Folded once per nick or casemapping change, not per line
+    wxScopedCharBuffer nickUtf8 = m_nick.ToUTF8();
+    m_isupport.caseFold().foldInto(std::string_view(nickUtf8.data(), nickUtf8.length()), m_nickKey);
+    std::atomic_store(&m_ownNick, std::make_shared<const OwnNick>(OwnNick{ m_isupport.caseFold(), m_nickKey }));
 }
 
 void ServerConnectionPanel::HandleDisconnect()
@@ -698,6 +995,42 @@ void ServerConnectionPanel::HandleJoinCommand(const wxString& text)
     }
 }
 
+// /stats: what the outgoing queue and the event queue have been doing,
+// and how much scrollback is held
+void ServerConnectionPanel::ShowStats()
+{
+    static const char* const classNames[SendPriorityCount] = { "urgent", "interactive", "bulk" };
+
+    const IRCCore::SendStats send = m_core.getSendStats();
+    LogToConsole(wxString::Format("Sent %llu line(s): wait before sending avg %.1f ms, max %.1f ms",
+                                  static_cast<unsigned long long>(send.linesSent),
+                                  send.linesSent ? double(send.totalLatencyUs) / double(send.linesSent) / 1000.0 : 0.0,
+                                  double(send.maxLatencyUs) / 1000.0));
+    for (std::size_t i = 0; i < SendPriorityCount; ++i)
+    {
+        const IRCCore::SendDelay& delay = send.byPriority[i];
+        LogToConsole(wxString::Format("  %s: %llu line(s), avg %.1f ms, max %.1f ms", classNames[i],
+                                      static_cast<unsigned long long>(delay.lines),
+                                      delay.lines ? double(delay.totalUs) / double(delay.lines) / 1000.0 : 0.0,
+                                      double(delay.maxUs) / 1000.0));
+    }
+    LogToConsole(wxString::Format("Held by flood control: %llu now, %llu at most",
+                                  static_cast<unsigned long long>(send.linesHeld),
+                                  static_cast<unsigned long long>(send.maxLinesHeld)));
+
+    LogToConsole(wxString::Format("Scrollback: %.1f KB in this connection's tabs, %.1f KB in all",
+                                  double(GetScrollbackBytes()) / 1024.0,
+                                  double(LogView::GetTotalMemoryUsage()) / 1024.0));
+    LogToConsole(wxString::Format("Users: %zu in this connection's channels, %.1f KB",
+                                  m_users.Size(), double(m_users.MemoryUsage()) / 1024.0));
+
+    const IrcEventQueue::Stats events = m_coreEvents.stats();
+    LogToConsole(wxString::Format("Event queue: %zu of %zu waiting, %zu at most, %llu overflowed, %llu dropped",
+                                  events.fill, events.capacity, events.highWater,
+                                  static_cast<unsigned long long>(events.overflowed),
+                                  static_cast<unsigned long long>(events.dropped)));
+}
+
 void ServerConnectionPanel::OnSend(wxCommandEvent&)
 {
     wxString text = m_input->GetValue();
@@ -723,6 +1056,14 @@ void ServerConnectionPanel::OnSend(wxCommandEvent&)
         return;
     }
 
+    // Client-side only; answered in the console whichever tab is open
+    if (lower == "/stats")
+    {
+        ShowStats();
+        m_input->Clear();
+        return;
+    }
+
     int sel = m_viewBook->GetSelection();
 
     if (sel <= 0)
@@ -733,7 +1074,7 @@ void ServerConnectionPanel::OnSend(wxCommandEvent&)
     else
     {
         // Channel tab
-        wxString chanName = m_viewBook->GetPageText(sel);
+        wxString chanName = ChannelNameAt(sel);
 
         if (!chanName.IsEmpty())
         {
@@ -748,7 +1089,7 @@ void ServerConnectionPanel::OnSend(wxCommandEvent&)
                     m_core.sendRaw(std::string(ctcp.ToUTF8()));
                     
                     // Echo locally
-                    auto it = m_channels.find(chanName);
+                    auto it = m_channels.find(ChannelKey(chanName));
                     if (it != m_channels.end())
                         it->second->AppendAction(m_nick, action);
                 }
@@ -765,7 +1106,7 @@ void ServerConnectionPanel::OnSend(wxCommandEvent&)
                 m_core.handleUserInput(std::string(out.ToUTF8()));
 
                 // Echo locally
-                auto it = m_channels.find(chanName);
+                auto it = m_channels.find(ChannelKey(chanName));
                 if (it != m_channels.end())
                     it->second->AppendChatMessage(m_nick, text);
             }
@@ -786,6 +1127,12 @@ void ServerConnectionPanel::OnTabClosed(wxAuiNotebookEvent& evt)
     {
         // Closing console = disconnect
         m_core.disconnect();
+        for (size_t i = 1; i < m_viewBook->GetPageCount(); ++i)
+        {
+            if (auto* channelPage = dynamic_cast<ChannelPage*>(m_viewBook->GetPage(i)))
+                channelPage->GetMembers().Clear();
+        }
+        m_users.Clear();
         m_channels.clear();
 
         // Update status bar
@@ -796,10 +1143,16 @@ void ServerConnectionPanel::OnTabClosed(wxAuiNotebookEvent& evt)
     }
 
     // Get channel name before it's removed
-    wxString chan = m_viewBook->GetPageText(page);
+    wxString chan = ChannelNameAt(page);
+
+    // Remove from our map, and its members from the connection's users
+    auto* closed = dynamic_cast<ChannelPage*>(m_viewBook->GetPage(static_cast<size_t>(page)));
+    if (closed)
+        closed->GetMembers().Clear();
 
-    // Remove from our map
-    m_channels.erase(chan);
+    auto it = m_channels.find(ChannelKey(chan));
+    if (it != m_channels.end() && it->second == closed)
+        m_channels.erase(it);
 
     // Send PART to server
     m_core.sendRaw("PART " + std::string(chan.ToUTF8()));
@@ -853,6 +1206,14 @@ void ServerConnectionPanel::OnInputKeyDown(wxKeyEvent& evt)
         wxString text = m_input->GetValue();
         long insertPos = m_input->GetInsertionPoint();
 
+        // Tab again straight after a nick completion: the next match
+        if (m_completion.matches.size() > 1 && text == m_completion.shown)
+        {
+            m_completion.index = (m_completion.index + 1) % m_completion.matches.size();
+            ShowCompletion();
+            return;
+        }
+
         // Find the word to complete (before cursor)
         long wordStart = insertPos;
         while (wordStart > 0 && !wxIsspace(text[wordStart - 1]))
@@ -868,7 +1229,7 @@ void ServerConnectionPanel::OnInputKeyDown(wxKeyEvent& evt)
             // Available commands
             static const wxArrayString commands = {
                 "/exit", "/join", "/j", "/leave", "/me", "/msg",
-                "/nick", "/part", "/privmsg", "/quit", "/raw"
+                "/nick", "/part", "/privmsg", "/quit", "/raw", "/stats"
             };
 
             // Find matching command
@@ -898,43 +1259,25 @@ void ServerConnectionPanel::OnInputKeyDown(wxKeyEvent& evt)
         if (sel <= 0)
             return;  // No completion in console
 
-        wxString chanName = m_viewBook->GetPageText(sel);
-        auto it = m_channels.find(chanName);
+        wxString chanName = ChannelNameAt(sel);
+        auto it = m_channels.find(ChannelKey(chanName));
         if (it == m_channels.end())
             return;
 
-        wxListBox* nickList = it->second->GetNickList();
-        if (!nickList)
+        // Matching nicks, whoever spoke last first
+        wxScopedCharBuffer prefixUtf8 = prefix.ToUTF8();
+        it->second->GetMembers().Complete(std::string_view(prefixUtf8.data(), prefixUtf8.length()),
+                                          m_completionIds);
+        if (m_completionIds.empty())
             return;
 
-        // Find matching nick
-        wxString match;
-        for (unsigned int i = 0; i < nickList->GetCount(); i++)
-        {
-            wxString nick = nickList->GetString(i);
-            if (nick.Lower().StartsWith(prefix.Lower()))
-            {
-                match = nick;
-                break;
-            }
-        }
-
-        if (!match.IsEmpty())
-        {
-            // Replace prefix with match
-            wxString before = text.Mid(0, wordStart);
-            wxString after = text.Mid(insertPos);
-
-            // Add colon if at start of line
-            wxString completion = match;
-            if (wordStart == 0)
-                completion += ": ";
-            else
-                completion += " ";
-
-            m_input->SetValue(before + completion + after);
-            m_input->SetInsertionPoint(wordStart + completion.Length());
-        }
+        m_completion.matches.clear();
+        for (UserRegistry::UserId id : m_completionIds)
+            m_completion.matches.push_back(ToWxString(m_users.Get(id).nick));
+        m_completion.index = 0;
+        m_completion.before = text.Mid(0, wordStart);
+        m_completion.after = text.Mid(insertPos);
+        ShowCompletion();
     }
     else
     {
@@ -943,8 +1286,22 @@ void ServerConnectionPanel::OnInputKeyDown(wxKeyEvent& evt)
     }
 }
 
+void ServerConnectionPanel::ShowCompletion()
+{
+    // Replace the word with the match, plus a colon at the start of the line
+    wxString completion = m_completion.matches[m_completion.index];
+    completion += m_completion.before.IsEmpty() ? ": " : " ";
+
+    m_input->SetValue(m_completion.before + completion + m_completion.after);
+    m_input->SetInsertionPoint(static_cast<long>(m_completion.before.Length() + completion.Length()));
+    m_completion.shown = m_input->GetValue();
+}
+
 void ServerConnectionPanel::OnTabChanged(wxAuiNotebookEvent&)
 {
+    // Matches belong to the channel they were found in
+    m_completion.matches.clear();
+    UpdateActivePage();
     UpdateWindowTitle();
 
     // Return focus to input box after tab change
@@ -974,7 +1331,7 @@ void ServerConnectionPanel::UpdateWindowTitle()
     else
     {
         // Channel tab
-        wxString channelName = m_viewBook->GetPageText(sel);
+        wxString channelName = ChannelNameAt(sel);
         title = "AstraIRC - " + channelName + " @ " + m_server;
     }
 
@@ -7,13 +7,21 @@
 #include <wx/listbox.h>
 #include <wx/aui/aui.h>
 #include <wx/timer.h>
-#include <map>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "ChannelPage.h"
 #include "irc_core.h"
+#include "irc_event_queue.h"
+#include "irc_isupport.h"
 #include "AppSettings.h"
 #include "UserInfo.h"
+#include "UserRegistry.h"
 
 // -------------------------------------------------------
 // ServerConnectionPanel
@@ -54,6 +62,14 @@ public:
     wxString GetPort() const { return m_port; }
     wxString GetNick() const { return m_nick; }
 
+    // Our nick against UTF-8 text, under the server's casemapping and
+    // without copying either side
+    bool IsOwnNick(std::string_view nick) const { return m_isupport.caseFold().equal(nick, m_nickKey); }
+    bool MentionsOwnNick(std::string_view text) const
+    {
+        return !m_nickKey.empty() && m_isupport.caseFold().contains(text, m_nickKey);
+    }
+
     // Core controls
     void DisconnectCore();
     void RequestNickChange(const wxString& newNick);
@@ -64,28 +80,71 @@ public:
     // WHOIS support
     void RequestWhois(const wxString& nick);
 
+    // Fill level and high-water mark of the network-to-GUI event ring
+    IrcEventQueue::Stats GetEventQueueStats() const { return m_coreEvents.stats(); }
+
+    // Approximate memory held by the console and channel scrollback
+    std::size_t GetScrollbackBytes() const;
+
+    // Whether this connection's tab is the one selected in the main window;
+    // while it is not, none of its pages render
+    void SetShown(bool shown);
+
 private:
     // Helpers
     wxString BuildConsoleTabTitle() const;
     void ConnectCore();
     void UpdateWindowTitle();
 
-    // Channel creation helper
+    // Channel lookup, by the name folded in the server's casemapping
+    std::string ChannelKey(std::string_view channelName) const;
+    std::string ChannelKey(const wxString& channelName) const;
+    ChannelPage* FindChannelPage(std::string_view channelName) const;
     ChannelPage* GetOrCreateChannelPage(const wxString& channelName);
+    bool IsChannelName(const wxString& name) const;
+
+    // Tabs
+    wxString ChannelNameAt(int pageIndex) const;
+    void UpdateActivePage();
+    void UpdateUnreadTitles();
 
-    // IRCCore callback handlers
+    // IRCCore events (queued on network threads, handled on the GUI thread)
+    void QueueCoreEvent(IrcEvent event);
+    void DrainCoreEvents();
     void HandleCoreLog(const wxString& msg);
-    void HandleCoreMessage(const wxString& source, const wxString& text);
-    void HandleRawLine(const wxString& line);
+    void HandleRawLine(const IrcMessage& msg);
+
+    // Server line handlers, looked up by IrcCommand ID
+    using RawLineHandler = void (ServerConnectionPanel::*)(const IrcMessage&);
+    void HandlePrivmsg(const IrcMessage& msg);
+    void HandleNotice(const IrcMessage& msg);
+    void HandleJoin(const IrcMessage& msg);
+    void HandlePart(const IrcMessage& msg);
+    void HandleQuit(const IrcMessage& msg);
+    void HandleKick(const IrcMessage& msg);
+    void HandleNick(const IrcMessage& msg);
+    void HandleTopic(const IrcMessage& msg);
+    void HandleTopicReply(const IrcMessage& msg);
+    void HandleNamesReply(const IrcMessage& msg);
+    void HandleEndOfNames(const IrcMessage& msg);
+    void HandleNickInUse(const IrcMessage& msg);
+    void HandleWelcome(const IrcMessage& msg);
+    void HandleServerText(const IrcMessage& msg);
+    void HandleISupport(const IrcMessage& msg);
+    void ApplyISupport();
+    void UpdateNickKey();
+    void HandleIgnored(const IrcMessage& msg);
     void HandleDisconnect();
     void HandleWhois(const UserInfo& userInfo);
 
     // UI handlers
     void HandleJoinCommand(const wxString& text);
+    void ShowStats();
     void OnSend(wxCommandEvent& evt);
     void OnTabClosed(wxAuiNotebookEvent& evt);
     void OnInputKeyDown(wxKeyEvent& evt);
     void OnTabChanged(wxAuiNotebookEvent& evt);
+    void ShowCompletion();
     void OnReconnectTimer(wxTimerEvent& evt);
 
 private:
@@ -94,6 +153,7 @@ private:
     LogPanel* m_consoleView = nullptr;  // console tab at index 0
     wxTextCtrl* m_input = nullptr;
     wxButton* m_btnSend = nullptr;
+    bool m_shown = true;  // our tab is selected in the main window
 
     // Connection fields
     wxString m_server;
@@ -101,11 +161,53 @@ private:
     wxString m_nick;
     wxString m_password;
 
+    // Events from m_core waiting for the GUI. Declared before m_core so it
+    // outlives the network threads that feed it.
+    IrcEventQueue m_coreEvents;
+    std::vector<IrcEvent> m_eventBatch;  // reused between drains
+    std::shared_ptr<const FormattedText> m_preformatted;  // of the line being handled, if any
+
     // Networking
     IRCCore m_core;
 
-    // Open channels (channel name -> page pointer)
-    std::map<wxString, ChannelPage*> m_channels;
+    // What the server announced in 005 (casemapping, prefixes, channel
+    // types). The channel types are mirrored as a mask of the characters
+    // below 64 for the network thread, which only uses it to pick lines to
+    // preformat.
+    IrcISupport m_isupport;
+    std::atomic<std::uint64_t> m_channelTypeMask{ 0 };
+
+    // Our nick in folded form, for highlight tests; the network thread
+    // reads its own copy (with the casemapping) through std::atomic_load
+    struct OwnNick
+    {
+        IrcCaseFold fold;
+        std::string key;
+    };
+    std::string m_nickKey;
+    std::shared_ptr<const OwnNick> m_ownNick;
+
+    // Users we share a channel with, referred to by the pages' member lists
+    UserRegistry m_users;
+
+    // Open channels (folded channel name -> page pointer)
+    std::unordered_map<std::string, ChannelPage*> m_channels;
+
+    // NAMES entries gathered from 353s until the channel's 366
+    // (folded channel name -> space-separated entries)
+    std::unordered_map<std::string, std::string> m_pendingNames;
+
+    // Nick completion in progress; Tab again cycles through the matches
+    struct NickCompletion
+    {
+        wxString before;  // input around the completed word
+        wxString after;
+        std::vector<wxString> matches;
+        std::size_t index = 0;
+        wxString shown;   // input as completion left it; anything else starts over
+    };
+    NickCompletion m_completion;
+    std::vector<UserRegistry::UserId> m_completionIds;  // reused between completions
 
     // Input history
     std::vector<wxString> m_inputHistory;
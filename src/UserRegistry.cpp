@@ -0,0 +1,186 @@
+#include "UserRegistry.h"
+#include "ChannelMembers.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+UserRegistry::UserId UserRegistry::Find(std::string_view nick) const
+{
+    auto it = m_ids.find(Fold(nick));
+    return it != m_ids.end() ? it->second : NoUser;
+}
+
+void UserRegistry::SetAddress(UserId id, std::string_view ident, std::string_view host)
+{
+    User& user = m_users[id];
+    if (user.ident != ident)
+        user.ident.assign(ident);
+    if (user.host != host)
+        user.host.assign(host);
+}
+
+void UserRegistry::Rename(UserId id, std::string_view newNick)
+{
+    std::string key = Fold(newNick);
+    User& user = m_users[id];
+    if (key != user.key)
+    {
+        // Someone we still thought had that nick must be gone
+        auto existing = m_ids.find(key);
+        if (existing != m_ids.end())
+            Remove(existing->second);
+
+        // Out of every list while the sort key changes
+        for (const Membership& membership : user.channels)
+            membership.channel->Unlink(id);
+
+        m_ids.erase(user.key);
+        user.key = std::move(key);
+        user.nick.assign(newNick);
+        m_ids.emplace(user.key, id);
+
+        for (const Membership& membership : user.channels)
+            membership.channel->Link(id);
+    }
+    else
+    {
+        // Case change only: the order is unaffected
+        user.nick.assign(newNick);
+    }
+}
+
+void UserRegistry::Remove(UserId id)
+{
+    // Leaving the last channel releases the user, so work on a copy
+    std::vector<Membership> channels = m_users[id].channels;
+    for (const Membership& membership : channels)
+        membership.channel->Remove(id);
+}
+
+void UserRegistry::Clear()
+{
+    m_users.resize(1);
+    m_freeIds.clear();
+    m_ids.clear();
+}
+
+std::size_t UserRegistry::MemoryUsage() const
+{
+    std::size_t bytes = m_users.size() * sizeof(User) + m_freeIds.capacity() * sizeof(UserId);
+    for (const User& user : m_users)
+    {
+        // Strings within the small-string buffer cost nothing extra
+        for (const std::string* text : { &user.nick, &user.key, &user.ident, &user.host })
+        {
+            if (text->capacity() > std::string().capacity())
+                bytes += text->capacity() + 1;
+        }
+        bytes += user.channels.capacity() * sizeof(Membership);
+    }
+
+    // Index: one node per user, plus the bucket array
+    bytes += m_ids.size() * (sizeof(std::pair<const std::string_view, UserId>) + 2 * sizeof(void*)) +
+             m_ids.bucket_count() * sizeof(void*);
+    return bytes;
+}
+
+void UserRegistry::SetCaseFold(const IrcCaseFold& fold)
+{
+    if (fold.mapping() == m_fold.mapping())
+        return;
+
+    // Drop the users who would collide while the lists are still sorted by
+    // the old keys
+    std::unordered_set<std::string> keys;
+    std::vector<UserId> collisions;
+    for (UserId id = 1; id < m_users.size(); ++id)
+    {
+        const User& user = m_users[id];
+        if (!user.channels.empty() && !keys.insert(fold.fold(user.nick)).second)
+            collisions.push_back(id);
+    }
+    for (UserId id : collisions)
+        Remove(id);
+
+    m_fold = fold;
+    m_ids.clear();
+    std::unordered_set<ChannelMembers*> channels;
+    for (UserId id = 1; id < m_users.size(); ++id)
+    {
+        User& user = m_users[id];
+        if (user.channels.empty())
+            continue;
+
+        user.key = m_fold.fold(user.nick);
+        m_ids.emplace(user.key, id);
+        for (const Membership& membership : user.channels)
+            channels.insert(membership.channel);
+    }
+
+    for (ChannelMembers* channel : channels)
+        channel->Resort();
+}
+
+UserRegistry::UserId UserRegistry::Intern(std::string_view nick)
+{
+    std::string key = Fold(nick);
+    auto it = m_ids.find(key);
+    if (it != m_ids.end())
+        return it->second;
+
+    UserId id;
+    if (!m_freeIds.empty())
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    else
+    {
+        id = static_cast<UserId>(m_users.size());
+        m_users.emplace_back();
+    }
+
+    User& user = m_users[id];
+    user.nick.assign(nick);
+    user.key = std::move(key);
+    m_ids.emplace(user.key, id);
+    return id;
+}
+
+UserRegistry::Membership* UserRegistry::FindMembership(UserId id, const ChannelMembers* channel)
+{
+    for (Membership& membership : m_users[id].channels)
+    {
+        if (membership.channel == channel)
+            return &membership;
+    }
+    return nullptr;
+}
+
+const UserRegistry::Membership* UserRegistry::FindMembership(UserId id, const ChannelMembers* channel) const
+{
+    return const_cast<UserRegistry*>(this)->FindMembership(id, channel);
+}
+
+void UserRegistry::AddMembership(UserId id, ChannelMembers* channel, std::uint8_t modes)
+{
+    m_users[id].channels.push_back(Membership{ channel, modes });
+}
+
+void UserRegistry::RemoveMembership(UserId id, const ChannelMembers* channel)
+{
+    std::vector<Membership>& channels = m_users[id].channels;
+    channels.erase(std::remove_if(channels.begin(), channels.end(),
+                                  [channel](const Membership& m) { return m.channel == channel; }),
+                   channels.end());
+    if (channels.empty())
+        Release(id);
+}
+
+void UserRegistry::Release(UserId id)
+{
+    User& user = m_users[id];
+    m_ids.erase(user.key);
+    user = User();
+    m_freeIds.push_back(id);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "irc_isupport.h"
+
+class ChannelMembers;
+
+// -------------------------------------------------------
+// UserRegistry
+// Every user we share a channel with on one connection, each stored once
+// under a small integer ID. Channel member lists hold only these IDs, and
+// each user records the channels it is in (with its prefix modes there),
+// so a QUIT or NICK visits exactly the channels the user is in.
+//
+// A user is forgotten when it leaves its last channel; its ID is reused.
+// -------------------------------------------------------
+
+class UserRegistry
+{
+public:
+    using UserId = std::uint32_t;
+    static constexpr UserId NoUser = 0;
+
+    struct Membership
+    {
+        ChannelMembers* channel = nullptr;
+        std::uint8_t modes = 0;    // prefix modes held there; bit 0 is the highest
+        std::uint32_t spoke = 0;   // the channel's message count when last heard, 0 if never
+    };
+
+    struct User
+    {
+        std::string nick;   // as the server spells it
+        std::string key;    // folded nick
+        std::string ident;  // user@host, once seen in a prefix
+        std::string host;
+        std::vector<Membership> channels;
+    };
+
+    UserRegistry() = default;
+    UserRegistry(const UserRegistry&) = delete;
+    UserRegistry& operator=(const UserRegistry&) = delete;
+
+    UserId Find(std::string_view nick) const;
+    const User& Get(UserId id) const { return m_users[id]; }
+
+    // Record where a user connects from (JOIN and message prefixes)
+    void SetAddress(UserId id, std::string_view ident, std::string_view host);
+
+    // NICK: the user keeps its ID and channels; their lists re-sort it
+    void Rename(UserId id, std::string_view newNick);
+
+    // QUIT: drop the user from every channel it is in
+    void Remove(UserId id);
+
+    // Forget everyone (disconnect); channel lists must be cleared first
+    void Clear();
+
+    std::size_t Size() const { return m_ids.size(); }
+
+    // Heap held by the user table and index
+    std::size_t MemoryUsage() const;
+
+    // Nicks are compared in the server's casemapping. Changing it re-keys
+    // everyone; of users who now collide, only the first is kept.
+    void SetCaseFold(const IrcCaseFold& fold);
+    const IrcCaseFold& CaseFold() const { return m_fold; }
+    std::string Fold(std::string_view nick) const { return m_fold.fold(nick); }
+
+private:
+    friend class ChannelMembers;
+
+    // Find or create; only channel lists add users
+    UserId Intern(std::string_view nick);
+    void Reserve(std::size_t moreUsers) { m_ids.reserve(m_ids.size() + moreUsers); }
+    Membership* FindMembership(UserId id, const ChannelMembers* channel);
+    const Membership* FindMembership(UserId id, const ChannelMembers* channel) const;
+    void AddMembership(UserId id, ChannelMembers* channel, std::uint8_t modes);
+    void RemoveMembership(UserId id, const ChannelMembers* channel);
+    void Release(UserId id);
+
+    // By ID; 0 is NoUser. A deque grows without copying users, so the
+    // index can key on their folded nicks in place.
+    std::deque<User> m_users{ User() };
+    std::vector<UserId> m_freeIds;
+    IrcCaseFold m_fold;
+    std::unordered_map<std::string_view, UserId> m_ids;  // User::key -> ID
+};
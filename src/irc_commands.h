@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// -------------------------------------------------------
+// IrcCommand
+// Every command is mapped to a small integer ID once, when the line is
+// parsed, so handlers are found by indexing a table rather than by string
+// compares. Three-digit numerics are their own ID (0-999); named commands
+// are numbered after them and looked up through a compile-time perfect hash.
+// -------------------------------------------------------
+
+enum class IrcCommand : std::uint16_t
+{
+    // Numerics (the value is the numeric)
+    RplWelcome = 1,
+    RplYourHost = 2,
+    RplCreated = 3,
+    RplMyInfo = 4,
+    RplISupport = 5,
+    RplAway = 301,
+    RplWhoisUser = 311,
+    RplWhoisServer = 312,
+    RplWhoisOperator = 313,
+    RplWhoisIdle = 317,
+    RplEndOfWhois = 318,
+    RplWhoisChannels = 319,
+    RplWhoisAccount = 330,
+    RplNoTopic = 331,
+    RplTopic = 332,
+    RplNamReply = 353,
+    RplEndOfNames = 366,
+    RplMotd = 372,
+    RplMotdStart = 375,
+    RplEndOfMotd = 376,
+    ErrNicknameInUse = 433,
+
+    // Named commands; keep in the same order as IrcCommandNames
+    Privmsg = 1000,
+    Notice,
+    Join,
+    Part,
+    Quit,
+    Kick,
+    Nick,
+    Topic,
+    Mode,
+    Ping,
+    Pong,
+    Error,
+    Invite,
+    Cap,
+    Authenticate,
+    Away,
+    Account,
+    Chghost,
+    Setname,
+    Batch,
+    Wallops,
+    Kill,
+    Tagmsg,
+    Pass,
+    User,
+    Whois,
+    Whowas,
+    Who,
+    Names,
+    List,
+
+    // Anything not listed above (and not a numeric)
+    Unknown
+};
+
+constexpr std::size_t IrcFirstNamedCommand = static_cast<std::size_t>(IrcCommand::Privmsg);
+constexpr std::size_t IrcCommandCount = static_cast<std::size_t>(IrcCommand::Unknown) + 1;
+
+constexpr std::size_t ircCommandIndex(IrcCommand command)
+{
+    return static_cast<std::size_t>(command);
+}
+
+constexpr std::array<std::string_view, IrcCommandCount - 1 - IrcFirstNamedCommand> IrcCommandNames = {
+    "PRIVMSG", "NOTICE", "JOIN", "PART", "QUIT", "KICK", "NICK", "TOPIC",
+    "MODE", "PING", "PONG", "ERROR", "INVITE", "CAP", "AUTHENTICATE", "AWAY",
+    "ACCOUNT", "CHGHOST", "SETNAME", "BATCH", "WALLOPS", "KILL", "TAGMSG",
+    "PASS", "USER", "WHOIS", "WHOWAS", "WHO", "NAMES", "LIST"
+};
+
+namespace IrcCommandHash
+{
+    constexpr std::size_t SlotCount = 64;
+    constexpr std::uint8_t EmptySlot = 0xFF;
+
+    // Multiplier chosen so every name above lands in its own slot; the
+    // static_assert below fails if a new name ever collides
+    constexpr std::uint32_t hash(std::string_view name)
+    {
+        std::uint32_t h = static_cast<std::uint32_t>(name.size());
+        for (char c : name)
+            h = h * 2823u + static_cast<unsigned char>(c);
+        return (h ^ (h >> 16)) % SlotCount;
+    }
+
+    // Slot -> index into IrcCommandNames
+    constexpr std::array<std::uint8_t, SlotCount> buildSlots()
+    {
+        std::array<std::uint8_t, SlotCount> slots{};
+        for (auto& slot : slots)
+            slot = EmptySlot;
+        for (std::size_t i = 0; i < IrcCommandNames.size(); ++i)
+            slots[hash(IrcCommandNames[i])] = static_cast<std::uint8_t>(i);
+        return slots;
+    }
+
+    constexpr bool isCollisionFree()
+    {
+        std::array<bool, SlotCount> used{};
+        for (std::string_view name : IrcCommandNames)
+        {
+            if (used[hash(name)])
+                return false;
+            used[hash(name)] = true;
+        }
+        return true;
+    }
+
+    static_assert(isCollisionFree(), "IRC command names collide; pick another multiplier");
+
+    constexpr std::array<std::uint8_t, SlotCount> Slots = buildSlots();
+}
+
+// Map a command word to its ID. Constant time: one digit check or one hash,
+// one table probe and one compare.
+constexpr IrcCommand ircCommandFromName(std::string_view name)
+{
+    if (name.size() == 3 &&
+        name[0] >= '0' && name[0] <= '9' &&
+        name[1] >= '0' && name[1] <= '9' &&
+        name[2] >= '0' && name[2] <= '9')
+    {
+        return static_cast<IrcCommand>((name[0] - '0') * 100 + (name[1] - '0') * 10 + (name[2] - '0'));
+    }
+
+    std::uint8_t index = IrcCommandHash::Slots[IrcCommandHash::hash(name)];
+    if (index != IrcCommandHash::EmptySlot && IrcCommandNames[index] == name)
+        return static_cast<IrcCommand>(IrcFirstNamedCommand + index);
+
+    return IrcCommand::Unknown;
+}
+
+static_assert(ircCommandFromName("PRIVMSG") == IrcCommand::Privmsg);
+static_assert(ircCommandFromName("LIST") == IrcCommand::List);
+static_assert(ircCommandFromName("353") == IrcCommand::RplNamReply);
+static_assert(ircCommandFromName("FOO") == IrcCommand::Unknown);
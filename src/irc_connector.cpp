@@ -0,0 +1,210 @@
+#include "irc_connector.h"
+
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+    #include <ws2tcpip.h>
+    #define CLOSE_SOCKET(s) closesocket(s)
+#else
+    #include <netinet/in.h>
+    #define CLOSE_SOCKET(s) close(s)
+#endif
+
+// Alternate address families, keeping the resolver's preference for the
+// first one (RFC 8305 section 4, with a First Address Family Count of 1)
+static std::vector<ConnectAddress> interleaveFamilies(std::vector<ConnectAddress> in)
+{
+    if (in.empty())
+        return in;
+
+    int preferred = in.front().family;
+    std::vector<ConnectAddress> first;
+    std::vector<ConnectAddress> second;
+    for (ConnectAddress& addr : in)
+        (addr.family == preferred ? first : second).push_back(addr);
+
+    std::vector<ConnectAddress> out;
+    out.reserve(in.size());
+    for (std::size_t i = 0; i < first.size() || i < second.size(); ++i)
+    {
+        if (i < first.size())
+            out.push_back(first[i]);
+        if (i < second.size())
+            out.push_back(second[i]);
+    }
+    return out;
+}
+
+// ----------------------
+// IRCConnector implementation
+// ----------------------
+
+IRCConnector::~IRCConnector()
+{
+    cancel();
+}
+
+void IRCConnector::start(std::vector<ConnectAddress> newAddresses, ResultCallback callback)
+{
+    // Drop whatever a previous run left behind
+    cancel();
+
+    Result result;
+    {
+        auto lock = IRCReactor::instance().lockCallbacks();
+        addresses = interleaveFamilies(std::move(newAddresses));
+        nextAddress = 0;
+        inFlight = 0;
+        lastError = "no addresses to connect to";
+        onResult = std::move(callback);
+        active = true;
+
+        launchNextAttempt(result);
+    }
+
+    // Every address failed immediately
+    if (result.callback)
+        result.callback(result.sock, result.error);
+}
+
+void IRCConnector::cancel()
+{
+    // Taking the lock also waits out a callback in progress, including a
+    // result being delivered for an attempt that just won
+    auto lock = IRCReactor::instance().lockCallbacks();
+    active = false;
+    onResult = nullptr;
+    addresses.clear();
+
+    for (auto& attempt : attempts)
+        closeAttempt(attempt.get());
+    attempts.clear();
+    inFlight = 0;
+}
+
+IRCConnector::Attempt* IRCConnector::startNextAttempt()
+{
+    // Caller holds the callback lock
+    while (nextAddress < addresses.size())
+    {
+        const ConnectAddress& address = addresses[nextAddress++];
+
+        SocketType s = socket(address.family, SOCK_STREAM, IPPROTO_TCP);
+        if (s == InvalidSocket)
+        {
+            lastError = "socket() failed";
+            continue;
+        }
+
+        if (!setSocketNonBlocking(s) ||
+            (connect(s, reinterpret_cast<const sockaddr*>(&address.addr), address.addrLen) != 0 &&
+             !socketConnectInProgress()))
+        {
+            lastError = "connect() failed";
+            CLOSE_SOCKET(s);
+            continue;
+        }
+
+        attempts.push_back(std::make_unique<Attempt>());
+        Attempt* attempt = attempts.back().get();
+        attempt->owner = this;
+        attempt->sock = s;
+
+        // Connect completion shows up as writable, failure as an error
+        if (!IRCReactor::instance().add(s, attempt, attempt->token))
+        {
+            lastError = "unable to register with the I/O reactor";
+            CLOSE_SOCKET(s);
+            attempt->sock = InvalidSocket;
+            continue;
+        }
+        IRCReactor::instance().setWriteInterest(attempt->token, true);
+
+        ++inFlight;
+        return attempt;
+    }
+
+    return nullptr;
+}
+
+void IRCConnector::launchNextAttempt(Result& result)
+{
+    // Caller holds the callback lock
+    if (Attempt* attempt = startNextAttempt())
+    {
+        // Give it a head start before racing the next address
+        if (nextAddress < addresses.size())
+            IRCReactor::instance().notifyAt(attempt->token, std::chrono::steady_clock::now() + AttemptDelay);
+        return;
+    }
+
+    if (inFlight == 0)
+        finish(InvalidSocket, lastError, result);
+}
+
+void IRCConnector::finish(SocketType sock, const std::string& error, Result& result)
+{
+    // The callback runs once the caller is done with our state
+    active = false;
+    result.callback = std::move(onResult);
+    result.sock = sock;
+    result.error = error;
+}
+
+void IRCConnector::closeAttempt(Attempt* attempt)
+{
+    // Caller holds the callback lock
+    IRCReactor::instance().remove(attempt->token);
+    if (attempt->sock != InvalidSocket)
+    {
+        CLOSE_SOCKET(attempt->sock);
+        attempt->sock = InvalidSocket;
+        --inFlight;
+    }
+}
+
+void IRCConnector::attemptReady(Attempt* attempt)
+{
+    if (!active || attempt->sock == InvalidSocket)
+        return;
+
+    Result result;
+    int error = socketPendingError(attempt->sock);
+    if (error == 0)
+    {
+        // Winner: hand its socket over and stop the rest
+        SocketType winner = attempt->sock;
+        IRCReactor::instance().remove(attempt->token);
+        attempt->sock = InvalidSocket;
+        --inFlight;
+
+        for (auto& other : attempts)
+            closeAttempt(other.get());
+
+        finish(winner, std::string(), result);
+    }
+    else
+    {
+        // RFC 8305: don't wait out the delay once an attempt has failed
+        lastError = std::system_category().message(error);
+        closeAttempt(attempt);
+        launchNextAttempt(result);
+    }
+
+    if (result.callback)
+        result.callback(result.sock, result.error);
+}
+
+void IRCConnector::attemptTimerExpired(Attempt* attempt)
+{
+    // A failed attempt has already started the next one
+    if (!active || attempt->sock == InvalidSocket || nextAddress >= addresses.size())
+        return;
+
+    Result result;
+    launchNextAttempt(result);
+
+    if (result.callback)
+        result.callback(result.sock, result.error);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "irc_reactor.h"
+#include "irc_socket.h"
+
+// One resolved address to try
+struct ConnectAddress
+{
+    sockaddr_storage addr{};
+    int addrLen{ 0 };
+    int family{ 0 };
+};
+
+// -------------------------------------------------------
+// IRCConnector
+// Non-blocking TCP connect racing several addresses ("Happy Eyeballs",
+// RFC 8305). Address families are interleaved, a new attempt starts every
+// AttemptDelay or as soon as the previous one fails, and the first socket
+// to connect wins; the others are dropped. All attempts run on the shared
+// IRCReactor, so no thread is blocked and cancel() takes effect at once.
+// -------------------------------------------------------
+
+class IRCConnector
+{
+public:
+    // Called once per start(): a connected non-blocking socket, or
+    // InvalidSocket and a reason. Runs on the reactor thread, or inside
+    // start() if every address fails straight away. Not called after cancel().
+    using ResultCallback = std::function<void(SocketType sock, const std::string& error)>;
+
+    static constexpr std::chrono::milliseconds AttemptDelay{ 250 };
+
+    IRCConnector() = default;
+    ~IRCConnector();
+
+    // Non-copyable, non-movable (attempts are registered with the reactor)
+    IRCConnector(const IRCConnector&) = delete;
+    IRCConnector& operator=(const IRCConnector&) = delete;
+
+    // Begin connecting. Addresses in resolver order; must not overlap with
+    // another start() or cancel().
+    void start(std::vector<ConnectAddress> addresses, ResultCallback onResult);
+
+    // Abandon every attempt. Once this returns no attempt is in flight and
+    // the result callback is not running and will not be called.
+    void cancel();
+
+private:
+    struct Attempt : IRCReactor::Handler
+    {
+        IRCConnector* owner{ nullptr };
+        SocketType sock{ InvalidSocket };
+        std::atomic<IRCReactor::Token> token{ IRCReactor::InvalidToken };
+
+        void onReadable() override { owner->attemptReady(this); }
+        void onWritable() override { owner->attemptReady(this); }
+        void onNotify() override { owner->attemptTimerExpired(this); }
+    };
+
+    // A finished run, delivered once the lock is released
+    struct Result
+    {
+        ResultCallback callback;
+        SocketType sock{ InvalidSocket };
+        std::string error;
+    };
+
+    // All state below is guarded by the reactor's callback lock, which the
+    // reactor thread holds whenever one of our handlers runs
+    Attempt* startNextAttempt();
+    void launchNextAttempt(Result& result);
+    void closeAttempt(Attempt* attempt);
+    void finish(SocketType sock, const std::string& error, Result& result);
+
+    // Reactor thread
+    void attemptReady(Attempt* attempt);
+    void attemptTimerExpired(Attempt* attempt);
+
+    std::vector<ConnectAddress> addresses;    // interleaved by family
+    std::size_t nextAddress{ 0 };
+    std::vector<std::unique_ptr<Attempt>> attempts;  // kept until cancel()/start() so handlers outlive registrations
+    std::size_t inFlight{ 0 };
+    std::string lastError;
+    ResultCallback onResult;
+    bool active{ false };  // a result is still owed
+};
@@ -1,6 +1,10 @@
 #include "irc_core.h"
 
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <iterator>
+#include <utility>
 #include <cstring>
 
 #ifdef _WIN32
@@ -12,16 +16,31 @@
     #define CLOSE_SOCKET(s) closesocket(s)
     #define SHUTDOWN_SOCKET(s) shutdown(s, SD_BOTH)
 #else
-    #include <sys/socket.h>
     #include <arpa/inet.h>
-    #include <netdb.h>
-    #include <unistd.h>
-    #include <cerrno>
     #define CLOSE_SOCKET(s) close(s)
     #define SHUTDOWN_SOCKET(s) shutdown(s, SHUT_RDWR)
-    #define SOCKET_ERROR (-1)
 #endif
 
+// Receive tuning: initial/minimum recv() size, and how many reads one
+// connection may do per reactor wakeup before yielding to the others
+static constexpr std::size_t MinReadChunk = 4096;
+static constexpr int MaxReadsPerWakeup = 4;
+
+// Lines gathered into one sendmsg()/WSASend() call
+static constexpr std::size_t MaxLinesPerWrite = 64;
+
+static constexpr std::size_t priorityIndex(SendPriority priority)
+{
+    return static_cast<std::size_t>(priority);
+}
+
+static std::uint64_t elapsedUs(std::chrono::steady_clock::time_point since,
+                               std::chrono::steady_clock::time_point now)
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - since).count());
+}
+
 // ----------------------
 // IRCCore implementation
 // ----------------------
@@ -76,6 +95,11 @@ void IRCCore::setWhoisCallback(WhoisCallback cb)
     onWhois = std::move(cb);
 }
 
+void IRCCore::setReceiveGate(ReceiveGateCallback cb)
+{
+    receiveGate = std::move(cb);
+}
+
 void IRCCore::log(const std::string& msg)
 {
     if (onLog)
@@ -95,6 +119,23 @@ std::string IRCCore::getNick() const
     return currentNick;
 }
 
+IRCCore::SendStats IRCCore::getSendStats() const
+{
+    SendStats stats;
+    stats.linesSent = statLinesSent.load();
+    stats.totalLatencyUs = statTotalLatencyUs.load();
+    stats.maxLatencyUs = statMaxLatencyUs.load();
+    for (std::size_t i = 0; i < SendPriorityCount; ++i)
+    {
+        stats.byPriority[i].lines = statClassLines[i].load();
+        stats.byPriority[i].totalUs = statClassTotalUs[i].load();
+        stats.byPriority[i].maxUs = statClassMaxUs[i].load();
+    }
+    stats.linesHeld = statLinesHeld.load();
+    stats.maxLinesHeld = statMaxLinesHeld.load();
+    return stats;
+}
+
 void IRCCore::requestWhois(const std::string& nick)
 {
     if (nick.empty() || !isConnected())
@@ -115,14 +156,24 @@ void IRCCore::requestWhois(const std::string& nick)
 
 void IRCCore::closeSocket()
 {
-    if (sock != InvalidSocket)
+    SocketType s = sock.exchange(InvalidSocket);
+    if (s != InvalidSocket)
     {
-        SHUTDOWN_SOCKET(sock);
-        CLOSE_SOCKET(sock);
-        sock = InvalidSocket;
+        SHUTDOWN_SOCKET(s);
+        CLOSE_SOCKET(s);
     }
 }
 
+void IRCCore::notifyDisconnected()
+{
+    // Exactly one onDisconnect per connectToServer(), whichever side ends it
+    if (!sessionActive.exchange(false))
+        return;
+
+    if (onDisconnect)
+        onDisconnect();
+}
+
 void IRCCore::connectToServer(const std::string& host, int port, const std::string& nick, const std::string& password)
 {
     // If already running, disconnect first
@@ -131,12 +182,6 @@ void IRCCore::connectToServer(const std::string& host, int port, const std::stri
         disconnect();
     }
 
-    // Ensure previous thread is fully cleaned up
-    if (networkThread.joinable())
-    {
-        networkThread.join();
-    }
-
     serverHost = host;
     serverPort = port;
     serverPassword = password;
@@ -146,8 +191,40 @@ void IRCCore::connectToServer(const std::string& host, int port, const std::stri
         currentNick = nick;
     }
 
+    // Nothing consumes the send side between connections, so its state can
+    // be reset from here
+    sendQueue.clear();
+    sendPending.clear();
+    sendOffset = 0;
+    flushScheduled = false;
+    for (auto& held : sendHeld)
+        held.clear();
+    floodSettingsChanged = false;
+    {
+        std::lock_guard<std::mutex> lock(floodSettingsMutex);
+        floodControl.configure(floodSettings, std::chrono::steady_clock::now());
+    }
+    floodControl.reset(std::chrono::steady_clock::now());
+    floodTimerAt = {};
+    backlogSince = {};
+    statLinesHeld = 0;
+    receivePaused = false;
+    resumeRequested = false;
+    recvBuffer.clear();
+    readChunk = MinReadChunk;
+
     running = true;
-    networkThread = std::thread(&IRCCore::networkThreadFunc, this);
+    sessionActive = true;
+
+    log("Connecting to " + serverHost + ":" + std::to_string(serverPort) + "...");
+
+    // A cached answer comes back before resolve() returns; otherwise a
+    // resolver thread calls back once the lookup is done
+    resolveRequest = IRCResolver::instance().resolve(
+        serverHost, serverPort,
+        [this](std::vector<ConnectAddress> addresses, const std::string& error) {
+            onResolved(std::move(addresses), error);
+        });
 }
 
 void IRCCore::disconnect()
@@ -157,24 +234,61 @@ void IRCCore::disconnect()
 
     running = false;
 
-    // Closing the socket will break recv() in the thread
+    // Stop waiting for the resolver, then drop any connect attempts still
+    // racing; after cancel() the connector can't hand us a socket any more
+    IRCResolver::instance().cancel(std::exchange(resolveRequest, IRCResolver::InvalidRequest));
+    connector.cancel();
+
+    // After remove() returns the reactor no longer touches this connection,
+    // so whatever is still queued (e.g. QUIT) can be flushed from here
+    IRCReactor::instance().remove(reactorToken.exchange(IRCReactor::InvalidToken));
+    if (sock != InvalidSocket)
+        flushSendQueue();
     closeSocket();
 
-    if (networkThread.joinable())
-        networkThread.join();
+    notifyDisconnected();
 
     log("Disconnected.");
 }
 
-void IRCCore::enqueueToSend(const std::string& lineWithCRLF)
+void IRCCore::enqueueToSend(const std::string& lineWithCRLF, SendPriority priority)
 {
-    std::lock_guard<std::mutex> lock(sendMutex);
-    sendQueue.push_back(lineWithCRLF);
+    sendQueue.push(OutgoingLine{ lineWithCRLF, std::chrono::steady_clock::now(), priority });
+
+    // Wake the reactor unless a flush is already on its way
+    if (!flushScheduled.exchange(true))
+        IRCReactor::instance().notify(reactorToken);
 }
 
 void IRCCore::sendRaw(const std::string& line)
 {
-    enqueueToSend(line + "\r\n");
+    sendRaw(line, classifyOutgoingLine(line));
+}
+
+void IRCCore::sendRaw(const std::string& line, SendPriority priority)
+{
+    enqueueToSend(line + "\r\n", priority);
+}
+
+void IRCCore::setFloodControl(const FloodControlSettings& settings)
+{
+    {
+        std::lock_guard<std::mutex> lock(floodSettingsMutex);
+        floodSettings = settings;
+    }
+    floodSettingsChanged = true;
+
+    // Re-run admission so held lines see the new rate right away
+    if (!flushScheduled.exchange(true))
+        IRCReactor::instance().notify(reactorToken);
+}
+
+// Something the user typed waits behind nothing but urgent traffic: a /join
+// or /whois they are looking at is not bulk, only programmatic ones are
+static SendPriority typedLinePriority(const std::string& line)
+{
+    SendPriority priority = classifyOutgoingLine(line);
+    return priority == SendPriority::Bulk ? SendPriority::Interactive : priority;
 }
 
 void IRCCore::handleUserInput(const std::string& line)
@@ -206,7 +320,7 @@ void IRCCore::handleUserInput(const std::string& line)
 
         if (cmdLower == "quit" || cmdLower == "exit")
         {
-            sendRaw("QUIT :Client exiting");
+            sendRaw("QUIT :Client exiting", SendPriority::Urgent);
             log("Sent QUIT; disconnecting.");
             disconnect();
         }
@@ -215,7 +329,7 @@ void IRCCore::handleUserInput(const std::string& line)
             if (!rest.empty())
             {
                 log("[Client] RAW: " + rest);
-                sendRaw(rest);
+                sendRaw(rest, typedLinePriority(rest));
             }
             else
             {
@@ -233,7 +347,7 @@ void IRCCore::handleUserInput(const std::string& line)
             {
                 std::string target = rest.substr(0, p);
                 std::string text = rest.substr(p + 1);
-                sendRaw("PRIVMSG " + target + " :" + text);
+                sendRaw("PRIVMSG " + target + " :" + text, SendPriority::Interactive);
 
                 if (onMessage)
                 {
@@ -246,7 +360,7 @@ void IRCCore::handleUserInput(const std::string& line)
         {
             if (!rest.empty())
             {
-                sendRaw("JOIN " + rest);
+                sendRaw("JOIN " + rest, SendPriority::Interactive);
             }
             else
             {
@@ -257,7 +371,7 @@ void IRCCore::handleUserInput(const std::string& line)
         {
             if (!rest.empty())
             {
-                sendRaw("PART " + rest);
+                sendRaw("PART " + rest, SendPriority::Interactive);
             }
             else
             {
@@ -268,7 +382,7 @@ void IRCCore::handleUserInput(const std::string& line)
         {
             if (!rest.empty())
             {
-                sendRaw("NICK " + rest);
+                sendRaw("NICK " + rest, SendPriority::Interactive);
             }
             else
             {
@@ -284,78 +398,62 @@ void IRCCore::handleUserInput(const std::string& line)
         {
             // Unknown command - send as raw IRC command
             log("[Client] Sending: " + cmdLine);
-            sendRaw(cmdLine);
+            sendRaw(cmdLine, typedLinePriority(cmdLine));
         }
     }
     else
     {
         // Not a command - send as raw (for console)
-        sendRaw(line);
+        sendRaw(line, typedLinePriority(line));
     }
 }
 
-void IRCCore::networkThreadFunc()
+void IRCCore::onResolved(std::vector<ConnectAddress> addresses, const std::string& error)
 {
-    log("Network thread starting for " + serverHost + ":" + std::to_string(serverPort));
-
-    // Resolve host
-    SocketType s = InvalidSocket;
-
-    addrinfo hints{};
-    hints.ai_family = AF_UNSPEC;      // IPv4 or IPv6
-    hints.ai_socktype = SOCK_STREAM;  // TCP
-    hints.ai_protocol = IPPROTO_TCP;
-
-    addrinfo* result = nullptr;
-    std::string portStr = std::to_string(serverPort);
+    // Resolver thread, or connectToServer() on a cache hit.
+    // disconnect() may have been requested while we were resolving.
+    if (!running.load())
+        return;
 
-    int res = getaddrinfo(serverHost.c_str(), portStr.c_str(), &hints, &result);
-    if (res != 0 || !result)
+    if (addresses.empty())
     {
-        log("getaddrinfo failed: " + std::to_string(res));
+        log("Unable to resolve " + serverHost + " (" + error + ").");
         running = false;
 
         // Notify GUI of connection failure
-        if (onDisconnect)
-            onDisconnect();
+        notifyDisconnected();
         return;
     }
 
-    // Try each address until we successfully connect
-    for (addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next)
-    {
-        s = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
-        if (s == InvalidSocket)
-            continue;
-
-        if (connect(s, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen)) == SOCKET_ERROR)
-        {
-            CLOSE_SOCKET(s);
-            s = InvalidSocket;
-            continue;
-        }
-
-        // Successfully connected
-        break;
-    }
-
-    freeaddrinfo(result);
+    // The connect itself runs on the reactor
+    connector.start(std::move(addresses), [this](SocketType s, const std::string& error) {
+        onConnectFinished(s, error);
+    });
+}
 
+void IRCCore::onConnectFinished(SocketType s, const std::string& error)
+{
     if (s == InvalidSocket)
     {
-        log("Unable to connect to server.");
+        log("Unable to connect to server (" + error + ").");
         running = false;
 
         // Notify GUI of connection failure
-        if (onDisconnect)
-            onDisconnect();
+        notifyDisconnected();
+        return;
+    }
+
+    // disconnect() is waiting in IRCConnector::cancel() and cleans up after us
+    if (!running.load())
+    {
+        CLOSE_SOCKET(s);
         return;
     }
 
     sock = s;
     log("Connected to " + serverHost + ":" + std::to_string(serverPort));
 
-    // Send initial IRC registration
+    // Send initial IRC registration; nothing else is useful until it's done
     {
         std::lock_guard<std::mutex> lock(nickMutex);
         if (!currentNick.empty())
@@ -363,488 +461,483 @@ void IRCCore::networkThreadFunc()
             // Send PASS command first if password is provided
             if (!serverPassword.empty())
             {
-                sendRaw("PASS " + serverPassword);
+                sendRaw("PASS " + serverPassword, SendPriority::Urgent);
             }
 
-            sendRaw("NICK " + currentNick);
-            sendRaw("USER " + currentNick + " 0 * :AstraIRC user");
+            sendRaw("NICK " + currentNick, SendPriority::Urgent);
+            sendRaw("USER " + currentNick + " 0 * :AstraIRC user", SendPriority::Urgent);
         }
     }
 
-    char buf[4096];
+    // Hand the socket to the shared I/O thread
+    if (!IRCReactor::instance().add(s, this, reactorToken))
+    {
+        log("Unable to register connection with the I/O reactor.");
+        closeSocket();
+        running = false;
+        notifyDisconnected();
+        return;
+    }
+
+    // The registration lines above were queued before we had a token
+    IRCReactor::instance().notify(reactorToken);
+}
+
+void IRCCore::connectionLost(const std::string& reason)
+{
+    // Reactor thread only
+    log(reason);
+    running = false;
+
+    IRCReactor::instance().remove(reactorToken.exchange(IRCReactor::InvalidToken));
+    closeSocket();
+
+    notifyDisconnected();
+}
+
+void IRCCore::admitHeldLines()
+{
+    // Consumer only. Sort new lines by priority, then move whatever flood
+    // control allows into sendPending.
+    auto now = std::chrono::steady_clock::now();
+
+    if (floodSettingsChanged.exchange(false))
+    {
+        std::lock_guard<std::mutex> lock(floodSettingsMutex);
+        floodControl.configure(floodSettings, now);
+    }
+
+    sendQueue.popAll(sendIncoming);
+    for (OutgoingLine& line : sendIncoming)
+        sendHeld[priorityIndex(line.priority)].push_back(std::move(line));
+    sendIncoming.clear();
 
-    while (running.load())
+    // Urgent lines skip the bucket (they still use up tokens) and go ahead of
+    // everything not yet on the wire; a half-written line has to finish first
+    auto& urgent = sendHeld[priorityIndex(SendPriority::Urgent)];
+    if (!urgent.empty())
     {
-        // Process send queue
+        for (std::size_t i = 0; i < urgent.size(); ++i)
+            floodControl.forceConsume(now);
+
+        auto pos = sendPending.begin() + (sendOffset > 0 ? 1 : 0);
+        sendPending.insert(pos, std::make_move_iterator(urgent.begin()), std::make_move_iterator(urgent.end()));
+        urgent.clear();
+    }
+
+    // Interactive before bulk while tokens last
+    std::size_t held = 0;
+    for (std::size_t p = priorityIndex(SendPriority::Interactive); p < SendPriorityCount; ++p)
+    {
+        auto& waiting = sendHeld[p];
+        while (!waiting.empty() && floodControl.tryConsume(now))
         {
-            std::vector<std::string> toSend;
-            {
-                std::lock_guard<std::mutex> lock(sendMutex);
-                toSend.swap(sendQueue);
-            }
+            sendPending.push_back(std::move(waiting.front()));
+            waiting.pop_front();
+        }
+        held += waiting.size();
+    }
 
-            for (const auto& line : toSend)
-            {
-                int sent = send(sock, line.c_str(), static_cast<int>(line.size()), 0);
-                if (sent == SOCKET_ERROR)
-                {
-                    log("send() failed, disconnecting.");
-                    running = false;
-                    break;
-                }
-                // Log without the trailing CRLF
-                if (line.size() >= 2)
-                    log("[Sent] " + line.substr(0, line.size() - 2));
-            }
+    statLinesHeld = held;
+    if (held > statMaxLinesHeld.load())
+        statMaxLinesHeld = held;
+
+    if (held == 0)
+    {
+        if (backlogSince != std::chrono::steady_clock::time_point{})
+        {
+            log("[Flood] Backlog sent after " + std::to_string(elapsedUs(backlogSince, now) / 1000) + " ms.");
+            backlogSince = {};
         }
+        return;
+    }
 
-        if (!running.load())
-            break;
+    if (backlogSince == std::chrono::steady_clock::time_point{})
+    {
+        backlogSince = now;
+        log("[Flood] Rate limit reached; pacing " + std::to_string(held) + " queued line(s).");
+    }
 
-        // Use select() to wait for data with a timeout
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(sock, &readfds);
+    // Come back when the next token is due, unless a timer already will
+    auto next = floodControl.nextTokenAt(now);
+    if (floodTimerAt <= now || next < floodTimerAt)
+    {
+        floodTimerAt = next;
+        IRCReactor::instance().notifyAt(reactorToken, next);
+    }
+}
 
-        timeval tv{};
-        tv.tv_sec = 0;
-        tv.tv_usec = 200000;  // 200ms timeout
+void IRCCore::recordSent(const OutgoingLine& line, std::chrono::steady_clock::time_point now)
+{
+    auto latencyUs = elapsedUs(line.queuedAt, now);
+    statLinesSent.fetch_add(1);
+    statTotalLatencyUs.fetch_add(latencyUs);
+    if (latencyUs > statMaxLatencyUs.load())
+        statMaxLatencyUs = latencyUs;
+
+    std::size_t p = priorityIndex(line.priority);
+    statClassLines[p].fetch_add(1);
+    statClassTotalUs[p].fetch_add(latencyUs);
+    if (latencyUs > statClassMaxUs[p].load())
+        statClassMaxUs[p] = latencyUs;
+}
 
-#ifdef _WIN32
-        int sel = select(0, &readfds, nullptr, nullptr, &tv);  // First param ignored on Windows
-#else
-        int sel = select(sock + 1, &readfds, nullptr, nullptr, &tv);
-#endif
+void IRCCore::flushSendQueue()
+{
+    // Consumer side of sendQueue: the reactor thread, or disconnect() once
+    // the connection has left the reactor
+    admitHeldLines();
 
-        if (sel == SOCKET_ERROR)
+    std::array<SocketBuffer, MaxLinesPerWrite> buffers;
+    while (!sendPending.empty())
+    {
+        // Gather the queued lines, resuming mid-line after a partial write
+        std::size_t count = 0;
+        std::size_t total = 0;
+        for (const OutgoingLine& line : sendPending)
         {
-            log("select() failed, disconnecting.");
-            running = false;
-            break;
+            if (count == buffers.size())
+                break;
+            std::size_t skip = (count == 0) ? sendOffset : 0;
+            setSocketBuffer(buffers[count++], line.data.data() + skip, line.data.size() - skip);
+            total += line.data.size() - skip;
         }
-        else if (sel == 0)
+
+        long sent = sendBuffers(sock, buffers.data(), count);
+        if (sent < 0)
         {
-            // Timeout - no data, continue loop
-            continue;
+            if (socketWouldBlock())
+                IRCReactor::instance().setWriteInterest(reactorToken, true);
+            else if (IRCReactor::instance().isReactorThread())
+                connectionLost("send() failed, disconnecting.");
+            return;
         }
 
-        if (FD_ISSET(sock, &readfds))
+        // Retire every line that went out completely
+        auto now = std::chrono::steady_clock::now();
+        std::size_t remaining = static_cast<std::size_t>(sent);
+        while (remaining > 0)
         {
-            int received = recv(sock, buf, sizeof(buf) - 1, 0);
-            if (received <= 0)
+            OutgoingLine& line = sendPending.front();
+            std::size_t left = line.data.size() - sendOffset;
+            if (remaining < left)
             {
-                if (received == 0)
-                    log("Server closed connection.");
-                else
-                    log("recv() error, disconnecting.");
-                running = false;
+                sendOffset += remaining;
                 break;
             }
 
-            buf[received] = '\0';
-            recvBuffer.append(buf);
+            remaining -= left;
+            sendOffset = 0;
 
-            // Process complete lines
-            std::size_t pos;
-            while ((pos = recvBuffer.find("\r\n")) != std::string::npos)
-            {
-                std::string line = recvBuffer.substr(0, pos);
-                recvBuffer.erase(0, pos + 2);
-                handleServerLine(line);
-            }
+            recordSent(line, now);
+            sendPending.pop_front();
+        }
+
+        if (static_cast<std::size_t>(sent) < total)
+        {
+            // Socket buffer is full; continue when it becomes writable
+            IRCReactor::instance().setWriteInterest(reactorToken, true);
+            return;
         }
     }
+}
 
-    closeSocket();
-    running = false;
+void IRCCore::onNotify()
+{
+    // Clear first so lines queued while we flush schedule another pass
+    flushScheduled = false;
+    flushSendQueue();
 
-    log("Network thread stopped.");
+    if (resumeRequested.exchange(false) && receivePaused.load() && sock != InvalidSocket)
+    {
+        receivePaused = false;
 
-    // Notify GUI of disconnection
-    if (onDisconnect)
-        onDisconnect();
+        // Lines parked in the buffer go first; reading resumes only if they
+        // all fit
+        if (processReceivedLines())
+            IRCReactor::instance().setReadInterest(reactorToken, true);
+    }
+}
+
+void IRCCore::onWritable()
+{
+    flushSendQueue();
+
+    if (sendPending.empty() && sendQueue.empty())
+        IRCReactor::instance().setWriteInterest(reactorToken, false);
+}
+
+bool IRCCore::processReceivedLines()
+{
+    // Reactor thread. Returns false if the connection went away or the
+    // consumer is full and receiving was paused.
+    std::string_view line;
+    for (;;)
+    {
+        if (receiveGate && !receiveGate() && pauseReceiving())
+            return false;
+
+        if (!recvBuffer.nextLine(line))
+            return true;
+
+        handleServerLine(line);
+
+        // A callback may have torn the connection down
+        if (sock == InvalidSocket)
+            return false;
+    }
+}
+
+bool IRCCore::pauseReceiving()
+{
+    receivePaused = true;
+
+    // Pairs with the fence in resumeReceiving(): either the consumer sees
+    // receivePaused, or we see the room it just made
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (receiveGate())
+    {
+        receivePaused = false;
+        return false;
+    }
+
+    // Unread lines stay in recvBuffer; the kernel buffer and then TCP flow
+    // control hold the rest back until the consumer catches up
+    IRCReactor::instance().setReadInterest(reactorToken, false);
+    return true;
+}
+
+void IRCCore::resumeReceiving()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!receivePaused.load())
+        return;
+
+    if (!resumeRequested.exchange(true))
+        IRCReactor::instance().notify(reactorToken);
 }
 
-void IRCCore::handleServerLine(const std::string& line)
+void IRCCore::onReadable()
 {
-    // Forward raw line to GUI for processing
+    // Drain what is available, but yield after a few reads so one busy
+    // connection can't starve the others sharing the reactor
+    for (int reads = 0; reads < MaxReadsPerWakeup; ++reads)
+    {
+        std::size_t available = 0;
+        char* dest = recvBuffer.prepareWrite(readChunk, available);
+        std::size_t want = std::min(readChunk, available);
+        if (want == 0)
+            return;  // buffer full of unprocessed lines; cannot happen unpaused
+
+        int received = recv(sock, dest, static_cast<int>(want), 0);
+        if (received <= 0)
+        {
+            if (received == 0)
+                connectionLost("Server closed connection.");
+            else if (!socketWouldBlock())
+                connectionLost("recv() error, disconnecting.");
+            return;
+        }
+
+        recvBuffer.commitWrite(static_cast<std::size_t>(received));
+
+        // Grow the read size while the socket keeps filling it (bursts like
+        // NAMES/MOTD/history), shrink it again once traffic is light
+        if (static_cast<std::size_t>(received) == want)
+            readChunk = std::min(readChunk * 2, recvBuffer.capacity() / 2);
+        else if (static_cast<std::size_t>(received) < readChunk / 4)
+            readChunk = std::max(readChunk / 2, MinReadChunk);
+
+        if (!processReceivedLines())
+            return;
+
+        if (static_cast<std::size_t>(received) < want)
+            return;  // socket drained
+    }
+}
+
+void IRCCore::handleServerLine(std::string_view line)
+{
+    // Parsed exactly once here; the GUI consumes the same message
+    IrcMessage msg;
+    if (!IrcMessage::parse(line, msg))
+        return;
+
+    // Forward parsed line to GUI for processing
     if (onRawLine)
-        onRawLine(line);
+        onRawLine(msg);
+
+    // One slot per command ID, built at compile time. Lines nobody handles
+    // here cost a single null check.
+    static constexpr auto handlers = [] {
+        std::array<ServerHandler, IrcCommandCount> table{};
+        table[ircCommandIndex(IrcCommand::Ping)] = &IRCCore::handlePing;
+        table[ircCommandIndex(IrcCommand::Privmsg)] = &IRCCore::handlePrivmsg;
+        table[ircCommandIndex(IrcCommand::Nick)] = &IRCCore::handleNick;
+        table[ircCommandIndex(IrcCommand::RplWhoisUser)] = &IRCCore::handleWhoisUser;
+        table[ircCommandIndex(IrcCommand::RplWhoisServer)] = &IRCCore::handleWhoisServer;
+        table[ircCommandIndex(IrcCommand::RplWhoisOperator)] = &IRCCore::handleWhoisOperator;
+        table[ircCommandIndex(IrcCommand::RplWhoisIdle)] = &IRCCore::handleWhoisIdle;
+        table[ircCommandIndex(IrcCommand::RplEndOfWhois)] = &IRCCore::handleEndOfWhois;
+        table[ircCommandIndex(IrcCommand::RplWhoisChannels)] = &IRCCore::handleWhoisChannels;
+        table[ircCommandIndex(IrcCommand::RplWhoisAccount)] = &IRCCore::handleWhoisAccount;
+        table[ircCommandIndex(IrcCommand::RplAway)] = &IRCCore::handleWhoisAway;
+        return table;
+    }();
+
+    ServerHandler handler = handlers[ircCommandIndex(msg.commandId)];
+    if (handler)
+        (this->*handler)(msg);
+}
+
+// ----------------------
+// Server command handlers (reactor thread)
+// ----------------------
 
+void IRCCore::handlePing(const IrcMessage& msg)
+{
     // Auto-reply to PING to keep connection alive
-    if (line.rfind("PING ", 0) == 0)
+    std::string payload = ":" + std::string(msg.param(0));
+    sendRaw("PONG " + payload);
+    log("[Auto] Replied with PONG " + payload);
+}
+
+void IRCCore::handlePrivmsg(const IrcMessage& msg)
+{
+    if (msg.paramCount >= 2 && onMessage)
+        onMessage(std::string(msg.prefix), std::string(msg.param(1)));
+}
+
+void IRCCore::handleNick(const IrcMessage& msg)
+{
+    // Update our nick if the change is ours
+    std::string_view newNick = msg.param(0);
+
+    std::lock_guard<std::mutex> lock(nickMutex);
+    if (!newNick.empty() && msg.nick == currentNick)
+        currentNick = std::string(newNick);
+}
+
+UserInfo* IRCCore::findPendingWhois(const IrcMessage& msg, std::size_t minParams)
+{
+    // Every WHOIS numeric is ":server NNN yournick targetnick ..."; caller
+    // holds whoisMutex
+    if (msg.paramCount < minParams)
+        return nullptr;
+
+    auto it = pendingWhois.find(msg.param(1));
+    return it != pendingWhois.end() ? &it->second : nullptr;
+}
+
+void IRCCore::handleWhoisUser(const IrcMessage& msg)
+{
+    // :server 311 yournick targetnick username hostname * :realname
+    std::lock_guard<std::mutex> lock(whoisMutex);
+    if (UserInfo* info = findPendingWhois(msg, 6))
     {
-        std::string payload = line.substr(5);
-        sendRaw("PONG " + payload);
-        log("[Auto] Replied with PONG " + payload);
-        return;
+        info->username = std::string(msg.param(2));
+        info->hostname = std::string(msg.param(3));
+        info->realname = std::string(msg.param(5));
+    }
+}
+
+void IRCCore::handleWhoisServer(const IrcMessage& msg)
+{
+    // :server 312 yournick targetnick servername :serverinfo
+    std::lock_guard<std::mutex> lock(whoisMutex);
+    if (UserInfo* info = findPendingWhois(msg, 3))
+    {
+        info->server = std::string(msg.param(2));
+        if (msg.paramCount >= 4)
+            info->serverInfo = std::string(msg.param(3));
+    }
+}
+
+void IRCCore::handleWhoisOperator(const IrcMessage& msg)
+{
+    // :server 313 yournick targetnick :is an IRC operator
+    std::lock_guard<std::mutex> lock(whoisMutex);
+    if (UserInfo* info = findPendingWhois(msg, 2))
+    {
+        info->isOperator = true;
+        if (msg.paramCount >= 3)
+            info->operatorInfo = std::string(msg.param(2));
+    }
+}
+
+void IRCCore::handleWhoisIdle(const IrcMessage& msg)
+{
+    // :server 317 yournick targetnick idle signon :seconds idle, signon time
+    std::lock_guard<std::mutex> lock(whoisMutex);
+    if (UserInfo* info = findPendingWhois(msg, 4))
+    {
+        info->idleSeconds = std::atoi(std::string(msg.param(2)).c_str());
+        info->signonTime = std::atol(std::string(msg.param(3)).c_str());
     }
+}
+
+void IRCCore::handleEndOfWhois(const IrcMessage& msg)
+{
+    // :server 318 yournick targetnick :End of WHOIS list
+    // Copy the UserInfo and invoke callback outside the lock
+    UserInfo info;
+    bool shouldNotify = false;
 
-    // Parse IRC message format: [:prefix] command [params] [:trailing]
-    if (!line.empty() && line[0] == ':')
     {
-        auto sp1 = line.find(' ');
-        if (sp1 != std::string::npos)
+        std::lock_guard<std::mutex> lock(whoisMutex);
+        if (UserInfo* pending = findPendingWhois(msg, 2))
         {
-            std::string prefix = line.substr(1, sp1 - 1);
-            auto sp2 = line.find(' ', sp1 + 1);
-            if (sp2 != std::string::npos)
-            {
-                std::string command = line.substr(sp1 + 1, sp2 - (sp1 + 1));
+            pending->whoisComplete = true;
+            pending->whoisInProgress = false;
+            info = *pending;  // Copy before erasing
 
-                // Handle PRIVMSG for the message callback
-                if (command == "PRIVMSG")
-                {
-                    auto sp3 = line.find(' ', sp2 + 1);
-                    if (sp3 != std::string::npos)
-                    {
-                        // std::string target = line.substr(sp2 + 1, sp3 - (sp2 + 1));
-                        std::string text;
-                        auto colon = line.find(" :", sp3);
-                        if (colon != std::string::npos)
-                            text = line.substr(colon + 2);
-
-                        if (onMessage)
-                            onMessage(prefix, text);
-                    }
-                }
-                // Handle NICK changes to update our nick if it's us
-                else if (command == "NICK")
-                {
-                    auto bang = prefix.find('!');
-                    std::string oldNick = (bang != std::string::npos) ? prefix.substr(0, bang) : prefix;
+            // Clean up
+            pendingWhois.erase(pendingWhois.find(msg.param(1)));
+            shouldNotify = true;
+        }
+    }  // Lock released here automatically
+
+    // Notify via callback outside the lock to avoid deadlock
+    if (shouldNotify && onWhois)
+    {
+        onWhois(info);
+    }
+}
 
-                    std::string newNick;
-                    auto colon = line.find(" :", sp2);
-                    if (colon != std::string::npos)
-                        newNick = line.substr(colon + 2);
-                    else
-                        newNick = line.substr(sp2 + 1);
+void IRCCore::handleWhoisChannels(const IrcMessage& msg)
+{
+    // :server 319 yournick targetnick :@#chan1 +#chan2 #chan3
+    std::lock_guard<std::mutex> lock(whoisMutex);
+    if (UserInfo* info = findPendingWhois(msg, 3))
+    {
+        std::string_view channelList = msg.param(2);
 
-                    std::lock_guard<std::mutex> lock(nickMutex);
-                    if (oldNick == currentNick)
-                        currentNick = newNick;
-                }
-                // Handle WHOIS numeric responses
-                else if (command == "311")  // RPL_WHOISUSER
-                {
-                    // :server 311 yournick targetnick username hostname * :realname
-                    std::vector<std::string> parts;
-                    std::string rest = line.substr(sp2 + 1);
-
-                    // Split by spaces, handling :trailing part
-                    size_t pos = 0;
-                    while (pos < rest.length())
-                    {
-                        if (rest[pos] == ':')
-                        {
-                            parts.push_back(rest.substr(pos + 1));
-                            break;
-                        }
-                        size_t next = rest.find(' ', pos);
-                        if (next == std::string::npos)
-                        {
-                            parts.push_back(rest.substr(pos));
-                            break;
-                        }
-                        parts.push_back(rest.substr(pos, next - pos));
-                        pos = next + 1;
-                    }
-
-                    if (parts.size() >= 5)
-                    {
-                        std::string targetNick = parts[1];
-                        std::lock_guard<std::mutex> lock(whoisMutex);
-                        auto it = pendingWhois.find(targetNick);
-                        if (it != pendingWhois.end())
-                        {
-                            it->second.username = parts[2];
-                            it->second.hostname = parts[3];
-                            it->second.realname = parts[5];
-                        }
-                    }
-                }
-                else if (command == "312")  // RPL_WHOISSERVER
-                {
-                    // :server 312 yournick targetnick servername :serverinfo
-                    std::vector<std::string> parts;
-                    std::string rest = line.substr(sp2 + 1);
-
-                    size_t pos = 0;
-                    while (pos < rest.length())
-                    {
-                        if (rest[pos] == ':')
-                        {
-                            parts.push_back(rest.substr(pos + 1));
-                            break;
-                        }
-                        size_t next = rest.find(' ', pos);
-                        if (next == std::string::npos)
-                        {
-                            parts.push_back(rest.substr(pos));
-                            break;
-                        }
-                        parts.push_back(rest.substr(pos, next - pos));
-                        pos = next + 1;
-                    }
-
-                    if (parts.size() >= 3)
-                    {
-                        std::string targetNick = parts[1];
-                        std::lock_guard<std::mutex> lock(whoisMutex);
-                        auto it = pendingWhois.find(targetNick);
-                        if (it != pendingWhois.end())
-                        {
-                            it->second.server = parts[2];
-                            if (parts.size() >= 4)
-                                it->second.serverInfo = parts[3];
-                        }
-                    }
-                }
-                else if (command == "313")  // RPL_WHOISOPERATOR
-                {
-                    // :server 313 yournick targetnick :is an IRC operator
-                    std::vector<std::string> parts;
-                    std::string rest = line.substr(sp2 + 1);
-
-                    size_t pos = 0;
-                    while (pos < rest.length())
-                    {
-                        if (rest[pos] == ':')
-                        {
-                            parts.push_back(rest.substr(pos + 1));
-                            break;
-                        }
-                        size_t next = rest.find(' ', pos);
-                        if (next == std::string::npos)
-                        {
-                            parts.push_back(rest.substr(pos));
-                            break;
-                        }
-                        parts.push_back(rest.substr(pos, next - pos));
-                        pos = next + 1;
-                    }
-
-                    if (parts.size() >= 2)
-                    {
-                        std::string targetNick = parts[1];
-                        std::lock_guard<std::mutex> lock(whoisMutex);
-                        auto it = pendingWhois.find(targetNick);
-                        if (it != pendingWhois.end())
-                        {
-                            it->second.isOperator = true;
-                            if (parts.size() >= 3)
-                                it->second.operatorInfo = parts[2];
-                        }
-                    }
-                }
-                else if (command == "317")  // RPL_WHOISIDLE
-                {
-                    // :server 317 yournick targetnick idle signon :seconds idle, signon time
-                    std::vector<std::string> parts;
-                    std::string rest = line.substr(sp2 + 1);
-
-                    size_t pos = 0;
-                    while (pos < rest.length())
-                    {
-                        if (rest[pos] == ':')
-                        {
-                            parts.push_back(rest.substr(pos + 1));
-                            break;
-                        }
-                        size_t next = rest.find(' ', pos);
-                        if (next == std::string::npos)
-                        {
-                            parts.push_back(rest.substr(pos));
-                            break;
-                        }
-                        parts.push_back(rest.substr(pos, next - pos));
-                        pos = next + 1;
-                    }
-
-                    if (parts.size() >= 4)
-                    {
-                        std::string targetNick = parts[1];
-                        std::lock_guard<std::mutex> lock(whoisMutex);
-                        auto it = pendingWhois.find(targetNick);
-                        if (it != pendingWhois.end())
-                        {
-                            it->second.idleSeconds = std::atoi(parts[2].c_str());
-                            it->second.signonTime = std::atol(parts[3].c_str());
-                        }
-                    }
-                }
-                else if (command == "318")  // RPL_ENDOFWHOIS
-                {
-                    // :server 318 yournick targetnick :End of WHOIS list
-                    std::vector<std::string> parts;
-                    std::string rest = line.substr(sp2 + 1);
-
-                    size_t pos = 0;
-                    while (pos < rest.length())
-                    {
-                        if (rest[pos] == ':')
-                        {
-                            parts.push_back(rest.substr(pos + 1));
-                            break;
-                        }
-                        size_t next = rest.find(' ', pos);
-                        if (next == std::string::npos)
-                        {
-                            parts.push_back(rest.substr(pos));
-                            break;
-                        }
-                        parts.push_back(rest.substr(pos, next - pos));
-                        pos = next + 1;
-                    }
-
-                    if (parts.size() >= 2)
-                    {
-                        std::string targetNick = parts[1];
-
-                        // Copy the UserInfo and invoke callback outside the lock
-                        UserInfo info;
-                        bool shouldNotify = false;
-
-                        {
-                            std::lock_guard<std::mutex> lock(whoisMutex);
-                            auto it = pendingWhois.find(targetNick);
-                            if (it != pendingWhois.end())
-                            {
-                                it->second.whoisComplete = true;
-                                it->second.whoisInProgress = false;
-                                info = it->second;  // Copy before erasing
-                                shouldNotify = true;
-
-                                // Clean up
-                                pendingWhois.erase(it);
-                            }
-                        }  // Lock released here automatically
-
-                        // Notify via callback outside the lock to avoid deadlock
-                        if (shouldNotify && onWhois)
-                        {
-                            onWhois(info);
-                        }
-                    }
-                }
-                else if (command == "319")  // RPL_WHOISCHANNELS
-                {
-                    // :server 319 yournick targetnick :@#chan1 +#chan2 #chan3
-                    std::vector<std::string> parts;
-                    std::string rest = line.substr(sp2 + 1);
-
-                    size_t pos = 0;
-                    while (pos < rest.length())
-                    {
-                        if (rest[pos] == ':')
-                        {
-                            parts.push_back(rest.substr(pos + 1));
-                            break;
-                        }
-                        size_t next = rest.find(' ', pos);
-                        if (next == std::string::npos)
-                        {
-                            parts.push_back(rest.substr(pos));
-                            break;
-                        }
-                        parts.push_back(rest.substr(pos, next - pos));
-                        pos = next + 1;
-                    }
-
-                    if (parts.size() >= 3)
-                    {
-                        std::string targetNick = parts[1];
-                        std::string channelList = parts[2];
-
-                        std::lock_guard<std::mutex> lock(whoisMutex);
-                        auto it = pendingWhois.find(targetNick);
-                        if (it != pendingWhois.end())
-                        {
-                            // Split channels by space
-                            std::string::size_type start = 0;
-                            std::string::size_type end = 0;
-                            while ((end = channelList.find(' ', start)) != std::string::npos)
-                            {
-                                it->second.channels.push_back(channelList.substr(start, end - start));
-                                start = end + 1;
-                            }
-                            if (start < channelList.length())
-                                it->second.channels.push_back(channelList.substr(start));
-                        }
-                    }
-                }
-                else if (command == "330")  // RPL_WHOISACCOUNT
-                {
-                    // :server 330 yournick targetnick accountname :is logged in as
-                    std::vector<std::string> parts;
-                    std::string rest = line.substr(sp2 + 1);
-
-                    size_t pos = 0;
-                    while (pos < rest.length())
-                    {
-                        if (rest[pos] == ':')
-                        {
-                            parts.push_back(rest.substr(pos + 1));
-                            break;
-                        }
-                        size_t next = rest.find(' ', pos);
-                        if (next == std::string::npos)
-                        {
-                            parts.push_back(rest.substr(pos));
-                            break;
-                        }
-                        parts.push_back(rest.substr(pos, next - pos));
-                        pos = next + 1;
-                    }
-
-                    if (parts.size() >= 3)
-                    {
-                        std::string targetNick = parts[1];
-                        std::lock_guard<std::mutex> lock(whoisMutex);
-                        auto it = pendingWhois.find(targetNick);
-                        if (it != pendingWhois.end())
-                        {
-                            it->second.account = parts[2];
-                        }
-                    }
-                }
-                else if (command == "301")  // RPL_AWAY
-                {
-                    // :server 301 yournick targetnick :away message
-                    std::vector<std::string> parts;
-                    std::string rest = line.substr(sp2 + 1);
-
-                    size_t pos = 0;
-                    while (pos < rest.length())
-                    {
-                        if (rest[pos] == ':')
-                        {
-                            parts.push_back(rest.substr(pos + 1));
-                            break;
-                        }
-                        size_t next = rest.find(' ', pos);
-                        if (next == std::string::npos)
-                        {
-                            parts.push_back(rest.substr(pos));
-                            break;
-                        }
-                        parts.push_back(rest.substr(pos, next - pos));
-                        pos = next + 1;
-                    }
-
-                    if (parts.size() >= 3)
-                    {
-                        std::string targetNick = parts[1];
-                        std::lock_guard<std::mutex> lock(whoisMutex);
-                        auto it = pendingWhois.find(targetNick);
-                        if (it != pendingWhois.end())
-                        {
-                            it->second.awayMessage = parts[2];
-                        }
-                    }
-                }
-            }
+        // Split channels by space
+        std::size_t start = 0;
+        while (start < channelList.size())
+        {
+            std::size_t end = channelList.find(' ', start);
+            if (end == std::string_view::npos)
+                end = channelList.size();
+            if (end > start)
+                info->channels.emplace_back(channelList.substr(start, end - start));
+            start = end + 1;
         }
     }
 }
+
+void IRCCore::handleWhoisAccount(const IrcMessage& msg)
+{
+    // :server 330 yournick targetnick accountname :is logged in as
+    std::lock_guard<std::mutex> lock(whoisMutex);
+    if (UserInfo* info = findPendingWhois(msg, 3))
+        info->account = std::string(msg.param(2));
+}
+
+void IRCCore::handleWhoisAway(const IrcMessage& msg)
+{
+    // :server 301 yournick targetnick :away message
+    std::lock_guard<std::mutex> lock(whoisMutex);
+    if (UserInfo* info = findPendingWhois(msg, 3))
+        info->awayMessage = std::string(msg.param(2));
+}
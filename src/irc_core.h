@@ -1,40 +1,71 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <functional>
-#include <thread>
 #include <atomic>
 #include <mutex>
 #include <vector>
 #include <map>
 #include "UserInfo.h"
-
-// Platform-specific socket type
-#ifdef _WIN32
-    #ifndef WIN32_LEAN_AND_MEAN
-        #define WIN32_LEAN_AND_MEAN
-    #endif
-    #include <winsock2.h>
-    using SocketType = SOCKET;
-    constexpr SocketType InvalidSocket = INVALID_SOCKET;
-#else
-    using SocketType = int;
-    constexpr SocketType InvalidSocket = -1;
-#endif
-
-class IRCCore
+#include "irc_connector.h"
+#include "irc_flood_control.h"
+#include "irc_linebuffer.h"
+#include "irc_message.h"
+#include "irc_reactor.h"
+#include "irc_resolver.h"
+#include "irc_send_queue.h"
+#include "irc_socket.h"
+
+// -------------------------------------------------------
+// IRCCore
+// Per-connection IRC state. Socket I/O for every connection is driven
+// by the shared IRCReactor thread; IRCCore only owns the socket and the
+// protocol state for one server.
+// -------------------------------------------------------
+
+class IRCCore : private IRCReactor::Handler
 {
 public:
     using LogCallback = std::function<void(const std::string&)>;
     using MessageCallback = std::function<void(const std::string& source, const std::string& text)>;
-    using RawLineCallback = std::function<void(const std::string&)>;
+    // Called on the reactor thread with the parsed line; the views are only
+    // valid during the call (copy into an IrcLine to keep it)
+    using RawLineCallback = std::function<void(const IrcMessage&)>;
     using DisconnectCallback = std::function<void()>;
     using WhoisCallback = std::function<void(const UserInfo&)>;
+    // Asked on the reactor thread before each received line is handled;
+    // returning false parks the input until resumeReceiving()
+    using ReceiveGateCallback = std::function<bool()>;
+
+    // Enqueue-to-send() latency of outgoing lines, for tuning and benchmarks.
+    // With flood control on this is mostly time spent waiting for the bucket,
+    // so byPriority shows what the current limits cost each class.
+    struct SendDelay
+    {
+        std::uint64_t lines = 0;
+        std::uint64_t totalUs = 0;
+        std::uint64_t maxUs = 0;
+    };
+
+    struct SendStats
+    {
+        std::uint64_t linesSent = 0;
+        std::uint64_t totalLatencyUs = 0;
+        std::uint64_t maxLatencyUs = 0;
+        std::array<SendDelay, SendPriorityCount> byPriority{};
+        std::uint64_t linesHeld = 0;     // waiting for flood control right now
+        std::uint64_t maxLinesHeld = 0;  // largest backlog seen
+    };
 
     IRCCore();
-    ~IRCCore();
+    ~IRCCore() override;
 
-    // Non-copyable, non-movable (due to thread and socket ownership)
+    // Non-copyable, non-movable (due to reactor registration and socket ownership)
     IRCCore(const IRCCore&) = delete;
     IRCCore& operator=(const IRCCore&) = delete;
     IRCCore(IRCCore&&) = delete;
@@ -46,6 +77,11 @@ public:
     void setRawLineCallback(RawLineCallback cb);
     void setDisconnectCallback(DisconnectCallback cb);
     void setWhoisCallback(WhoisCallback cb);
+    void setReceiveGate(ReceiveGateCallback cb);
+
+    // Backpressure: the consumer made room again after the receive gate
+    // said no. Thread-safe and cheap when receiving is not paused.
+    void resumeReceiving();
 
     // Connection management
     void connectToServer(const std::string& host, int port, const std::string& nick, const std::string& password = "");
@@ -55,32 +91,71 @@ public:
     // From GUI: stuff the user typed into the console
     void handleUserInput(const std::string& line);
 
-    // Raw IRC line (no CRLF needed; IRCCore adds it)
+    // Raw IRC line (no CRLF needed; IRCCore adds it). The one-argument form
+    // picks the priority from the command (see classifyOutgoingLine).
     void sendRaw(const std::string& line);
+    void sendRaw(const std::string& line, SendPriority priority);
+
+    // Outgoing rate limit. Thread-safe; takes effect on the next flush.
+    void setFloodControl(const FloodControlSettings& settings);
 
     // Accessors
     std::string getNick() const;
+    SendStats getSendStats() const;
 
     // WHOIS support
     void requestWhois(const std::string& nick);
 
 private:
     // Internal helpers
-    void networkThreadFunc();
+    void onResolved(std::vector<ConnectAddress> addresses, const std::string& error);
+    void onConnectFinished(SocketType s, const std::string& error);
     void log(const std::string& msg);
-    void handleServerLine(const std::string& line);
-    void enqueueToSend(const std::string& lineWithCRLF);
+    void handleServerLine(std::string_view line);
+    bool processReceivedLines();
+    bool pauseReceiving();
+
+    // Server command handlers, looked up by IrcCommand ID
+    using ServerHandler = void (IRCCore::*)(const IrcMessage&);
+    void handlePing(const IrcMessage& msg);
+    void handlePrivmsg(const IrcMessage& msg);
+    void handleNick(const IrcMessage& msg);
+    void handleWhoisUser(const IrcMessage& msg);
+    void handleWhoisServer(const IrcMessage& msg);
+    void handleWhoisOperator(const IrcMessage& msg);
+    void handleWhoisIdle(const IrcMessage& msg);
+    void handleEndOfWhois(const IrcMessage& msg);
+    void handleWhoisChannels(const IrcMessage& msg);
+    void handleWhoisAccount(const IrcMessage& msg);
+    void handleWhoisAway(const IrcMessage& msg);
+    UserInfo* findPendingWhois(const IrcMessage& msg, std::size_t minParams);
+    void enqueueToSend(const std::string& lineWithCRLF, SendPriority priority);
+    void flushSendQueue();
+    void admitHeldLines();
+    void recordSent(const OutgoingLine& line, std::chrono::steady_clock::time_point now);
     void closeSocket();
+    void connectionLost(const std::string& reason);
+    void notifyDisconnected();
+
+    // IRCReactor::Handler (reactor thread)
+    void onReadable() override;
+    void onWritable() override;
+    void onNotify() override;
 
 private:
-    // Thread / run state
-    std::thread networkThread;
+    // Run state. Setting up a connection takes no thread of its own: the
+    // shared resolver looks the host up, connector races the addresses on
+    // the reactor, which then drives the socket.
+    IRCResolver::RequestId resolveRequest{ IRCResolver::InvalidRequest };  // GUI thread only
+    IRCConnector connector;
     std::atomic<bool> running{ false };
+    std::atomic<bool> sessionActive{ false };  // onDisconnect still owed to the GUI
+    std::atomic<IRCReactor::Token> reactorToken{ IRCReactor::InvalidToken };
 
     // Connection info
     std::string serverHost;
     int serverPort{ 6667 };
-    SocketType sock{ InvalidSocket };
+    std::atomic<SocketType> sock{ InvalidSocket };
     std::string currentNick;
     std::string serverPassword;
     mutable std::mutex nickMutex;
@@ -91,17 +166,49 @@ private:
     RawLineCallback onRawLine;
     DisconnectCallback onDisconnect;
     WhoisCallback onWhois;
+    ReceiveGateCallback receiveGate;
 
     // WHOIS tracking
     std::mutex whoisMutex;
-    std::map<std::string, UserInfo> pendingWhois;
-
-    // Outgoing queue
-    std::mutex sendMutex;
-    std::vector<std::string> sendQueue;
-
-    // Incoming line buffer
-    std::string recvBuffer;
+    std::map<std::string, UserInfo, std::less<>> pendingWhois;  // transparent: find() by string_view
+
+    // Outgoing queue. Enqueuing notifies the reactor, which flushes right
+    // away; flushScheduled collapses a burst of lines into one wakeup.
+    IRCSendQueue sendQueue;
+    std::deque<OutgoingLine> sendPending;  // admitted by flood control, not yet fully written
+    std::size_t sendOffset{ 0 };           // bytes of sendPending.front() already written
+    std::atomic<bool> flushScheduled{ false };
+
+    // Flood control (consumer side only, like sendPending). Lines wait in
+    // sendHeld by priority until the bucket admits them; a reactor timer
+    // wakes us when the next token is due.
+    std::deque<OutgoingLine> sendIncoming;  // scratch for popAll()
+    std::array<std::deque<OutgoingLine>, SendPriorityCount> sendHeld;
+    IRCFloodControl floodControl;
+    std::chrono::steady_clock::time_point floodTimerAt{};
+    std::chrono::steady_clock::time_point backlogSince{};
+    std::mutex floodSettingsMutex;
+    FloodControlSettings floodSettings;            // guarded by floodSettingsMutex
+    std::atomic<bool> floodSettingsChanged{ false };
+
+    // Send latency statistics (written by the consumer only)
+    std::atomic<std::uint64_t> statLinesSent{ 0 };
+    std::atomic<std::uint64_t> statTotalLatencyUs{ 0 };
+    std::atomic<std::uint64_t> statMaxLatencyUs{ 0 };
+    std::array<std::atomic<std::uint64_t>, SendPriorityCount> statClassLines{};
+    std::array<std::atomic<std::uint64_t>, SendPriorityCount> statClassTotalUs{};
+    std::array<std::atomic<std::uint64_t>, SendPriorityCount> statClassMaxUs{};
+    std::atomic<std::uint64_t> statLinesHeld{ 0 };
+    std::atomic<std::uint64_t> statMaxLinesHeld{ 0 };
+
+    // Incoming data (reactor thread only). readChunk adapts between
+    // MinReadChunk and the buffer size depending on how much recv() returns.
+    IRCLineBuffer recvBuffer;
+    std::size_t readChunk{ 4096 };
+
+    // Backpressure from the consumer (see setReceiveGate)
+    std::atomic<bool> receivePaused{ false };    // gate said no; socket reads are off
+    std::atomic<bool> resumeRequested{ false };  // resume notify already posted
 
     // For one-time Winsock init on Windows
 #ifdef _WIN32
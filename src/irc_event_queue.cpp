@@ -0,0 +1,138 @@
+#include "irc_event_queue.h"
+#include "irc_reactor.h"
+
+#include <utility>
+
+// ----------------------
+// IrcEventQueue implementation
+// ----------------------
+
+static std::size_t roundUpToPowerOfTwo(std::size_t value)
+{
+    std::size_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+IrcEventQueue::IrcEventQueue(std::size_t capacity)
+{
+    std::size_t size = roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity);
+    slots = std::make_unique<IrcEvent[]>(size);
+    mask = size - 1;
+}
+
+bool IrcEventQueue::push(IrcEvent event)
+{
+    // The reactor thread is the ring's only producer
+    if (!IRCReactor::instance().isReactorThread() || !pushToRing(event))
+    {
+        std::lock_guard<std::mutex> lock(sideMutex);
+        if (sideEvents.size() >= SideCapacity && event.type != IrcEvent::Type::Disconnected)
+        {
+            // A drain is already scheduled for what is waiting
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        sideEvents.push_back(SideEvent{ std::move(event), head.load(std::memory_order_acquire) });
+        sideCount.store(sideEvents.size(), std::memory_order_release);
+    }
+
+    return scheduleDrain();
+}
+
+bool IrcEventQueue::pushToRing(IrcEvent& event)
+{
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    const std::size_t fill = h - tail.load(std::memory_order_acquire);
+    if (fill > mask)
+    {
+        // Only reachable if the producer ignored hasRoom(); never drop
+        overflowed.store(overflowed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    slots[h & mask] = std::move(event);
+    // seq_cst pairs with drain(): either the consumer sees this event or we
+    // see drainScheduled cleared and post a new drain
+    head.store(h + 1, std::memory_order_seq_cst);
+
+    if (fill + 1 > highWater.load(std::memory_order_relaxed))
+        highWater.store(fill + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool IrcEventQueue::scheduleDrain()
+{
+    // Cheap load first: during a burst a drain is almost always pending
+    if (drainScheduled.load(std::memory_order_seq_cst))
+        return false;
+    return !drainScheduled.exchange(true, std::memory_order_seq_cst);
+}
+
+bool IrcEventQueue::hasRoom(std::size_t reserve) const
+{
+    const std::size_t fill = head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire);
+    return fill + reserve <= mask + 1;
+}
+
+bool IrcEventQueue::drain(std::vector<IrcEvent>& out, std::size_t maxEvents)
+{
+    out.clear();
+
+    // Anything pushed from here on schedules another drain
+    drainScheduled.store(false, std::memory_order_seq_cst);
+
+    if (sideCount.load(std::memory_order_acquire) != 0)
+    {
+        std::lock_guard<std::mutex> lock(sideMutex);
+        for (SideEvent& side : sideEvents)
+            sideBacklog.push_back(std::move(side));
+        sideEvents.clear();
+        sideCount.store(0, std::memory_order_relaxed);
+    }
+
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    const std::size_t h = head.load(std::memory_order_seq_cst);
+
+    while (out.size() < maxEvents)
+    {
+        // A side event goes out once every ring event pushed before it has
+        if (!sideBacklog.empty() && sideBacklog.front().ringPosition <= t)
+        {
+            out.push_back(std::move(sideBacklog.front().event));
+            sideBacklog.pop_front();
+            continue;
+        }
+
+        if (t == h)
+            break;
+
+        out.push_back(std::move(slots[t & mask]));
+        ++t;
+    }
+
+    // Hands the slots back to the producer
+    tail.store(t, std::memory_order_release);
+
+    const bool more = t != head.load(std::memory_order_acquire) ||
+                      !sideBacklog.empty() ||
+                      sideCount.load(std::memory_order_acquire) != 0;
+    if (!more)
+        return false;
+
+    // Claim the wakeup ourselves unless a producer already posted one
+    return !drainScheduled.exchange(true, std::memory_order_seq_cst);
+}
+
+IrcEventQueue::Stats IrcEventQueue::stats() const
+{
+    Stats result;
+    result.capacity = mask + 1;
+    const std::size_t t = tail.load(std::memory_order_acquire);  // tail first: it never passes head
+    result.fill = head.load(std::memory_order_acquire) - t;
+    result.highWater = highWater.load(std::memory_order_relaxed);
+    result.overflowed = overflowed.load(std::memory_order_relaxed);
+    result.dropped = dropped.load(std::memory_order_relaxed);
+    return result;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "UserInfo.h"
+#include "irc_message.h"
+
+// Message text formatted for display before it reaches the GUI (LogFormat.h)
+struct FormattedText;
+
+// -------------------------------------------------------
+// IrcEvent
+// One thing IRCCore reports to the GUI: a parsed server line, a log
+// message, a finished WHOIS, or the end of the connection.
+// -------------------------------------------------------
+
+struct IrcEvent
+{
+    enum class Type
+    {
+        Line,
+        Log,
+        Whois,
+        Disconnected
+    };
+
+    Type type = Type::Line;
+    IrcLine line;                           // Type::Line
+    std::shared_ptr<const FormattedText> formatted;  // Type::Line, channel chat only
+    std::string text;                       // Type::Log
+    std::shared_ptr<const UserInfo> whois;  // Type::Whois (rare, kept out of line)
+};
+
+// -------------------------------------------------------
+// IrcEventQueue
+// Bounded hand-off of events from one connection to the GUI.
+// Events pushed on the reactor thread (every received line) go through a
+// fixed-size single-producer/single-consumer ring: a push is a couple of
+// atomic loads and stores, and memory stays flat however far the GUI
+// falls behind. The few events raised on other threads (connect progress,
+// user commands) go through a small locked list and are merged back in
+// the order they were pushed.
+//
+// The ring never drops: the producer is expected to check hasRoom() and
+// stop reading from the socket while it is full (see
+// IRCCore::setReceiveGate()), so a slow GUI pushes back on the server
+// through TCP flow control instead of growing the heap. Nothing gates the
+// side list, so it is capped at SideCapacity undrained events; past that,
+// pushes are dropped and counted, except the end of the connection,
+// which the GUI must always see.
+// -------------------------------------------------------
+
+class IrcEventQueue
+{
+public:
+    static constexpr std::size_t DefaultCapacity = 1024;
+
+    // Free slots the producer keeps in hand before handling another line;
+    // one line can raise a few events (line, log, WHOIS result, ...)
+    static constexpr std::size_t LineReserve = 8;
+
+    // Most events the side list holds between drains
+    static constexpr std::size_t SideCapacity = 256;
+
+    struct Stats
+    {
+        std::size_t capacity = 0;
+        std::size_t fill = 0;            // events waiting in the ring now
+        std::size_t highWater = 0;       // largest fill seen so far
+        std::uint64_t overflowed = 0;    // ring-full pushes moved to the side list
+        std::uint64_t dropped = 0;       // pushes refused with the side list full
+    };
+
+    // Capacity is rounded up to a power of two
+    explicit IrcEventQueue(std::size_t capacity = DefaultCapacity);
+
+    // Non-copyable, non-movable (shared between threads)
+    IrcEventQueue(const IrcEventQueue&) = delete;
+    IrcEventQueue& operator=(const IrcEventQueue&) = delete;
+
+    // Any thread. Returns true if the consumer must be scheduled to drain;
+    // that happens only for the first event after a drain.
+    bool push(IrcEvent event);
+
+    // Reactor thread: true while the ring can take another line's events
+    bool hasRoom(std::size_t reserve = LineReserve) const;
+
+    // Consumer thread. Moves up to maxEvents into `out` (cleared first).
+    // Returns true if events remain and the caller must schedule another
+    // drain itself.
+    bool drain(std::vector<IrcEvent>& out, std::size_t maxEvents);
+
+    Stats stats() const;
+
+private:
+    bool pushToRing(IrcEvent& event);
+    bool scheduleDrain();
+
+    struct SideEvent
+    {
+        IrcEvent event;
+        std::size_t ringPosition;  // ring head when pushed, for ordering
+    };
+
+    // Ring. head is written only by the producer, tail only by the consumer.
+    std::unique_ptr<IrcEvent[]> slots;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head{ 0 };
+    alignas(64) std::atomic<std::size_t> tail{ 0 };
+    alignas(64) std::atomic<bool> drainScheduled{ false };
+
+    // Producer-written statistics
+    std::atomic<std::size_t> highWater{ 0 };
+    std::atomic<std::uint64_t> overflowed{ 0 };
+
+    // Events from threads other than the producer
+    std::mutex sideMutex;
+    std::vector<SideEvent> sideEvents;
+    std::atomic<std::size_t> sideCount{ 0 };
+    std::atomic<std::uint64_t> dropped{ 0 };
+
+    // Consumer-only: side events waiting for their turn
+    std::deque<SideEvent> sideBacklog;
+};
@@ -0,0 +1,98 @@
+#include "irc_flood_control.h"
+#include "irc_commands.h"
+
+#include <algorithm>
+
+// ----------------------
+// Outgoing line classification
+// ----------------------
+
+SendPriority classifyOutgoingLine(std::string_view line)
+{
+    std::string_view command = line.substr(0, line.find(' '));
+
+    switch (ircCommandFromName(command))
+    {
+    case IrcCommand::Pong:
+    case IrcCommand::Quit:
+    case IrcCommand::Pass:
+    case IrcCommand::User:
+    case IrcCommand::Cap:
+    case IrcCommand::Authenticate:
+        return SendPriority::Urgent;
+
+    case IrcCommand::Join:
+    case IrcCommand::Whois:
+    case IrcCommand::Whowas:
+    case IrcCommand::Who:
+    case IrcCommand::Names:
+    case IrcCommand::List:
+        return SendPriority::Bulk;
+
+    default:
+        return SendPriority::Interactive;
+    }
+}
+
+// ----------------------
+// IRCFloodControl implementation
+// ----------------------
+
+void IRCFloodControl::configure(const FloodControlSettings& newSettings, Clock::time_point now)
+{
+    refill(now);
+    settings = newSettings;
+    settings.burstLines = std::max(settings.burstLines, 1);
+    settings.refillIntervalMs = std::max(settings.refillIntervalMs, 1);
+    tokens = std::min(tokens, static_cast<double>(settings.burstLines));
+}
+
+void IRCFloodControl::reset(Clock::time_point now)
+{
+    tokens = settings.burstLines;
+    lastRefill = now;
+}
+
+void IRCFloodControl::refill(Clock::time_point now)
+{
+    if (now <= lastRefill)
+        return;
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(now - lastRefill).count();
+    tokens = std::min(tokens + elapsedMs / settings.refillIntervalMs,
+                      static_cast<double>(settings.burstLines));
+    lastRefill = now;
+}
+
+bool IRCFloodControl::tryConsume(Clock::time_point now)
+{
+    if (!settings.enabled)
+        return true;
+
+    refill(now);
+    if (tokens < 1.0)
+        return false;
+
+    tokens -= 1.0;
+    return true;
+}
+
+void IRCFloodControl::forceConsume(Clock::time_point now)
+{
+    if (!settings.enabled)
+        return;
+
+    refill(now);
+    // Bound the debt so a long run of urgent lines can't stall output forever
+    tokens = std::max(tokens - 1.0, -static_cast<double>(settings.burstLines));
+}
+
+IRCFloodControl::Clock::time_point IRCFloodControl::nextTokenAt(Clock::time_point now)
+{
+    refill(now);
+    if (!settings.enabled || tokens >= 1.0)
+        return now;
+
+    auto waitUs = static_cast<std::int64_t>((1.0 - tokens) * settings.refillIntervalMs * 1000.0) + 1;
+    return now + std::chrono::microseconds(waitUs);
+}
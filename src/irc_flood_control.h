@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Outgoing flood control (token bucket), configurable per server
+struct FloodControlSettings
+{
+    bool enabled = true;
+    int burstLines = 5;           // lines that may go out back to back
+    int refillIntervalMs = 2000;  // one more line is allowed per interval
+};
+
+// Scheduling class of an outgoing line; lower values go first
+enum class SendPriority : std::uint8_t
+{
+    Urgent,       // PONG, QUIT, registration: skip the bucket entirely
+    Interactive,  // messages and anything the user typed
+    Bulk          // WHOIS/WHO/NAMES/LIST and programmatic JOINs
+};
+
+constexpr std::size_t SendPriorityCount = 3;
+
+// Pick a class from the command word of a raw outgoing line
+SendPriority classifyOutgoingLine(std::string_view line);
+
+// -------------------------------------------------------
+// IRCFloodControl
+// Token bucket pacing one connection's output. Tokens refill at one per
+// refillIntervalMs up to burstLines. Urgent lines are charged too but are
+// never held back, so the bucket may briefly run into debt.
+// -------------------------------------------------------
+
+class IRCFloodControl
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps the current fill (clamped to the new burst size)
+    void configure(const FloodControlSettings& settings, Clock::time_point now);
+
+    // Full bucket, e.g. for a new connection
+    void reset(Clock::time_point now);
+
+    // Take one token if available. Always succeeds when disabled.
+    bool tryConsume(Clock::time_point now);
+
+    // Take one token whether or not one is available
+    void forceConsume(Clock::time_point now);
+
+    // When the next token becomes available (now if one already is)
+    Clock::time_point nextTokenAt(Clock::time_point now);
+
+    bool enabled() const { return settings.enabled; }
+
+private:
+    void refill(Clock::time_point now);
+
+    FloodControlSettings settings;
+    double tokens{ 0.0 };
+    Clock::time_point lastRefill{};
+};
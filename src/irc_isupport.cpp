@@ -0,0 +1,252 @@
+#include "irc_isupport.h"
+#include "irc_message.h"
+
+#include <algorithm>
+
+using FoldTable = std::array<unsigned char, 256>;
+
+static FoldTable makeFoldTable(IrcCaseMapping mapping)
+{
+    FoldTable table{};
+    for (int c = 0; c < 256; ++c)
+        table[c] = static_cast<unsigned char>(c);
+    for (int c = 'A'; c <= 'Z'; ++c)
+        table[c] = static_cast<unsigned char>(c - 'A' + 'a');
+
+    if (mapping != IrcCaseMapping::Ascii)
+    {
+        table['['] = '{';
+        table[']'] = '}';
+        table['\\'] = '|';
+        if (mapping == IrcCaseMapping::Rfc1459)
+            table['~'] = '^';
+    }
+    return table;
+}
+
+static const FoldTable& foldTable(IrcCaseMapping mapping)
+{
+    static const FoldTable ascii = makeFoldTable(IrcCaseMapping::Ascii);
+    static const FoldTable rfc1459 = makeFoldTable(IrcCaseMapping::Rfc1459);
+    static const FoldTable strict = makeFoldTable(IrcCaseMapping::StrictRfc1459);
+
+    switch (mapping)
+    {
+    case IrcCaseMapping::Ascii:
+        return ascii;
+    case IrcCaseMapping::StrictRfc1459:
+        return strict;
+    case IrcCaseMapping::Rfc1459:
+        break;
+    }
+    return rfc1459;
+}
+
+static IrcCaseMapping parseCaseMapping(std::string_view name)
+{
+    // rfc7613 (PRECIS) folds beyond ASCII too, which we leave alone;
+    // within ASCII it is plain ascii
+    if (name == "ascii" || name == "rfc7613")
+        return IrcCaseMapping::Ascii;
+    if (name == "strict-rfc1459")
+        return IrcCaseMapping::StrictRfc1459;
+    return IrcCaseMapping::Rfc1459;
+}
+
+static int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// Values escape spaces, '=' and '\' as \xHH
+static std::string unescapeValue(std::string_view value)
+{
+    std::string out;
+    out.reserve(value.size());
+    for (std::size_t i = 0; i < value.size(); ++i)
+    {
+        if (value[i] == '\\' && i + 3 < value.size() && value[i + 1] == 'x')
+        {
+            int high = hexDigit(value[i + 2]);
+            int low = hexDigit(value[i + 3]);
+            if (high >= 0 && low >= 0)
+            {
+                out += static_cast<char>(high * 16 + low);
+                i += 3;
+                continue;
+            }
+        }
+        out += value[i];
+    }
+    return out;
+}
+
+static constexpr std::string_view DefaultPrefix = "(qaohv)~&@%+";
+static constexpr std::string_view DefaultChannelTypes = "#&!+";
+
+// ---------- IrcCaseFold ----------
+
+IrcCaseFold::IrcCaseFold(IrcCaseMapping mapping)
+    : caseMapping(mapping),
+      table(&foldTable(mapping))
+{
+}
+
+std::string IrcCaseFold::fold(std::string_view text) const
+{
+    std::string out;
+    foldInto(text, out);
+    return out;
+}
+
+void IrcCaseFold::foldInto(std::string_view text, std::string& out) const
+{
+    out.resize(text.size());
+    const FoldTable& map = *table;
+    for (std::size_t i = 0; i < text.size(); ++i)
+        out[i] = static_cast<char>(map[static_cast<unsigned char>(text[i])]);
+}
+
+bool IrcCaseFold::equal(std::string_view a, std::string_view b) const
+{
+    if (a.size() != b.size())
+        return false;
+
+    const FoldTable& map = *table;
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        if (map[static_cast<unsigned char>(a[i])] != map[static_cast<unsigned char>(b[i])])
+            return false;
+    }
+    return true;
+}
+
+bool IrcCaseFold::contains(std::string_view text, std::string_view foldedName) const
+{
+    if (foldedName.empty())
+        return true;
+    if (text.size() < foldedName.size())
+        return false;
+
+    const FoldTable& map = *table;
+    const auto first = static_cast<unsigned char>(foldedName.front());
+    const std::size_t last = text.size() - foldedName.size();
+    for (std::size_t i = 0; i <= last; ++i)
+    {
+        if (map[static_cast<unsigned char>(text[i])] != first)
+            continue;
+
+        std::size_t j = 1;
+        while (j < foldedName.size() &&
+               map[static_cast<unsigned char>(text[i + j])] == static_cast<unsigned char>(foldedName[j]))
+            ++j;
+        if (j == foldedName.size())
+            return true;
+    }
+    return false;
+}
+
+// ---------- IrcISupport ----------
+
+IrcISupport::IrcISupport()
+{
+    reset();
+}
+
+void IrcISupport::reset()
+{
+    tokens.clear();
+    resetToken("CASEMAPPING");
+    resetToken("PREFIX");
+    resetToken("CHANTYPES");
+}
+
+bool IrcISupport::apply(const IrcMessage& msg)
+{
+    const IrcCaseMapping oldMapping = fold.mapping();
+    const std::string oldSymbols = symbols;
+    const std::string oldTypes = chanTypes;
+
+    // <nick> token... :are supported by this server
+    for (std::size_t i = 1; i < msg.middleCount(); ++i)
+    {
+        std::string_view token = msg.param(i);
+        if (token.empty())
+            continue;
+
+        // "-NAME" withdraws an earlier token
+        if (token.front() == '-')
+        {
+            token.remove_prefix(1);
+            tokens.erase(std::string(token));
+            resetToken(token);
+            continue;
+        }
+
+        std::size_t eq = token.find('=');
+        std::string_view name = token.substr(0, eq);
+        std::string value = eq == std::string_view::npos ? std::string() : unescapeValue(token.substr(eq + 1));
+        setToken(name, value);
+        tokens[std::string(name)] = std::move(value);
+    }
+
+    return fold.mapping() != oldMapping || symbols != oldSymbols || chanTypes != oldTypes;
+}
+
+bool IrcISupport::get(std::string_view name, std::string& value) const
+{
+    auto it = tokens.find(std::string(name));
+    if (it == tokens.end())
+        return false;
+
+    value = it->second;
+    return true;
+}
+
+bool IrcISupport::isChannel(std::string_view name) const
+{
+    return !name.empty() && chanTypes.find(name.front()) != std::string::npos;
+}
+
+void IrcISupport::setToken(std::string_view name, std::string_view value)
+{
+    if (name == "CASEMAPPING")
+    {
+        fold = IrcCaseFold(parseCaseMapping(value));
+    }
+    else if (name == "PREFIX")
+    {
+        // "(modes)symbols", paired up in order; empty means no prefixes
+        modes.clear();
+        symbols.clear();
+        std::size_t close = value.find(')');
+        if (!value.empty() && value.front() == '(' && close != std::string_view::npos)
+        {
+            std::string_view letters = value.substr(1, close - 1);
+            std::string_view marks = value.substr(close + 1);
+            std::size_t count = std::min({ letters.size(), marks.size(), std::size_t{ 8 } });
+            modes.assign(letters.substr(0, count));
+            symbols.assign(marks.substr(0, count));
+        }
+    }
+    else if (name == "CHANTYPES")
+    {
+        chanTypes.assign(value);
+    }
+}
+
+void IrcISupport::resetToken(std::string_view name)
+{
+    if (name == "CASEMAPPING")
+        setToken(name, "rfc1459");
+    else if (name == "PREFIX")
+        setToken(name, DefaultPrefix);
+    else if (name == "CHANTYPES")
+        setToken(name, DefaultChannelTypes);
+}
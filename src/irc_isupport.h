@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct IrcMessage;
+
+// Which characters a server treats as case variants of each other
+enum class IrcCaseMapping : std::uint8_t
+{
+    Ascii,          // A-Z only
+    Rfc1459,        // also []\~ as the upper case of {}|^
+    StrictRfc1459   // also []\ as the upper case of {}|
+};
+
+// -------------------------------------------------------
+// IrcCaseFold
+// Maps nicks and channel names to the form they are compared in, by one
+// 256-entry table lookup per byte. Every index keyed on a nick or channel
+// name stores this folded form, so looking one up is a single hash of the
+// name as received; bytes outside ASCII are left alone, which is what
+// servers do too.
+// -------------------------------------------------------
+
+class IrcCaseFold
+{
+public:
+    explicit IrcCaseFold(IrcCaseMapping mapping = IrcCaseMapping::Rfc1459);
+
+    IrcCaseMapping mapping() const { return caseMapping; }
+
+    char fold(char c) const { return static_cast<char>((*table)[static_cast<unsigned char>(c)]); }
+    std::string fold(std::string_view text) const;
+
+    // Fold into an existing string, reusing its buffer
+    void foldInto(std::string_view text, std::string& out) const;
+
+    bool equal(std::string_view a, std::string_view b) const;
+
+    // Whether text contains a name already in folded form, e.g. a cached
+    // nick key; text is folded as it is scanned, not copied
+    bool contains(std::string_view text, std::string_view foldedName) const;
+
+private:
+    IrcCaseMapping caseMapping;
+    const std::array<unsigned char, 256>* table;  // shared per mapping
+};
+
+// -------------------------------------------------------
+// IrcISupport
+// What the server announced about itself in RPL_ISUPPORT (005). Every
+// token is kept as sent; the few the client acts on are parsed as they
+// arrive. Until a server says otherwise the defaults are the lenient ones
+// the client always assumed: rfc1459 casemapping, the ~&@%+ prefixes and
+// the #&!+ channel types.
+// -------------------------------------------------------
+
+class IrcISupport
+{
+public:
+    IrcISupport();
+
+    // Take the tokens from one 005 line. Returns true if the casemapping,
+    // prefixes or channel types changed.
+    bool apply(const IrcMessage& msg);
+
+    // Back to the defaults, for a new connection
+    void reset();
+
+    // Value of a token ("" if it has none); false if it was not announced
+    bool get(std::string_view name, std::string& value) const;
+
+    const IrcCaseFold& caseFold() const { return fold; }
+
+    // PREFIX: channel modes giving a nick prefix and their symbols, both
+    // highest first, e.g. "ov" and "@+"
+    const std::string& prefixModes() const { return modes; }
+    const std::string& prefixSymbols() const { return symbols; }
+
+    // CHANTYPES: characters a channel name may start with
+    const std::string& channelTypes() const { return chanTypes; }
+    bool isChannel(std::string_view name) const;
+
+private:
+    void setToken(std::string_view name, std::string_view value);
+    void resetToken(std::string_view name);
+
+    std::unordered_map<std::string, std::string> tokens;
+    IrcCaseFold fold;
+    std::string modes;
+    std::string symbols;
+    std::string chanTypes;
+};
@@ -0,0 +1,86 @@
+#include "irc_linebuffer.h"
+
+#include <cstring>
+
+// ----------------------
+// IRCLineBuffer implementation
+// ----------------------
+
+IRCLineBuffer::IRCLineBuffer(std::size_t capacity)
+    : buffer(capacity)
+{
+}
+
+void IRCLineBuffer::clear()
+{
+    readPos = scanPos = writePos = 0;
+    discarding = false;
+}
+
+char* IRCLineBuffer::prepareWrite(std::size_t wanted, std::size_t& available)
+{
+    if (readPos == writePos)
+    {
+        // Everything consumed (the common case): rewind for free
+        readPos = scanPos = writePos = 0;
+    }
+    else if (buffer.size() - writePos < wanted && readPos > 0)
+    {
+        // Slide the partial line to the front; it is at most one line long
+        std::size_t len = writePos - readPos;
+        std::memmove(buffer.data(), buffer.data() + readPos, len);
+        scanPos -= readPos;
+        writePos = len;
+        readPos = 0;
+    }
+
+    if (writePos == buffer.size())
+    {
+        // A single line filled the whole buffer without a terminator. Drop
+        // it and skip everything up to the next LF.
+        readPos = scanPos = writePos = 0;
+        discarding = true;
+    }
+
+    available = buffer.size() - writePos;
+    return buffer.data() + writePos;
+}
+
+void IRCLineBuffer::commitWrite(std::size_t count)
+{
+    writePos += count;
+}
+
+bool IRCLineBuffer::nextLine(std::string_view& line)
+{
+    for (;;)
+    {
+        const char* base = buffer.data();
+        const void* lf = std::memchr(base + scanPos, '\n', writePos - scanPos);
+        if (!lf)
+        {
+            scanPos = writePos;
+            return false;
+        }
+
+        std::size_t end = static_cast<const char*>(lf) - base;
+        std::size_t start = readPos;
+        readPos = scanPos = end + 1;
+
+        if (discarding)
+        {
+            discarding = false;
+            continue;
+        }
+
+        // Accept both CRLF and bare LF terminators
+        if (end > start && base[end - 1] == '\r')
+            --end;
+
+        if (end == start)
+            continue;  // ignore empty lines
+
+        line = std::string_view(base + start, end - start);
+        return true;
+    }
+}
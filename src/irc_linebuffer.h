@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// -------------------------------------------------------
+// IRCLineBuffer
+// Fixed-capacity receive buffer for one connection. recv() writes
+// straight into it and complete lines are handed out as views, so the
+// bytes are copied once (kernel -> buffer) and never shifted per line.
+// Leftover partial lines are compacted to the front only when the free
+// tail gets too small for the next read.
+// -------------------------------------------------------
+
+class IRCLineBuffer
+{
+public:
+    // Generous for IRCv3 tags (8191) + message (512); longer lines are dropped
+    static constexpr std::size_t DefaultCapacity = 64 * 1024;
+
+    explicit IRCLineBuffer(std::size_t capacity = DefaultCapacity);
+
+    // Free space for the next recv(). Compacts first if the tail is smaller
+    // than `wanted`; may still return less if a partial line fills the buffer.
+    char* prepareWrite(std::size_t wanted, std::size_t& available);
+
+    // Mark `count` bytes after prepareWrite() as received
+    void commitWrite(std::size_t count);
+
+    // Next complete line without its CR/LF. The view stays valid until the
+    // next prepareWrite()/clear(). Embedded NUL bytes are preserved.
+    bool nextLine(std::string_view& line);
+
+    void clear();
+
+    std::size_t capacity() const { return buffer.size(); }
+    std::size_t pending() const { return writePos - readPos; }
+
+private:
+    std::vector<char> buffer;
+    std::size_t readPos{ 0 };    // start of the first incomplete line
+    std::size_t scanPos{ 0 };    // bytes before this are known to hold no LF
+    std::size_t writePos{ 0 };   // end of received data
+    bool discarding{ false };    // dropping an overlong line up to its LF
+};
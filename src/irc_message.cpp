@@ -0,0 +1,157 @@
+#include "irc_message.h"
+
+#include <utility>
+
+// ----------------------
+// IrcMessage implementation
+// ----------------------
+
+bool IrcMessage::parse(std::string_view line, IrcMessage& out)
+{
+    out = IrcMessage();
+    out.raw = line;
+
+    std::size_t pos = 0;
+    const std::size_t len = line.size();
+
+    auto skipSpaces = [&]() {
+        while (pos < len && line[pos] == ' ')
+            ++pos;
+    };
+
+    // Token up to the next space (or end of line)
+    auto word = [&]() {
+        std::size_t start = pos;
+        std::size_t end = line.find(' ', pos);
+        if (end == std::string_view::npos)
+            end = len;
+        pos = end;
+        return line.substr(start, end - start);
+    };
+
+    // @tags
+    if (pos < len && line[pos] == '@')
+    {
+        ++pos;
+        out.tags = word();
+        skipSpaces();
+    }
+
+    // :prefix, split into nick!user@host
+    if (pos < len && line[pos] == ':')
+    {
+        ++pos;
+        out.prefix = word();
+        skipSpaces();
+
+        std::string_view pfx = out.prefix;
+        std::size_t at = pfx.find('@');
+        if (at != std::string_view::npos)
+        {
+            out.host = pfx.substr(at + 1);
+            pfx = pfx.substr(0, at);
+        }
+        std::size_t bang = pfx.find('!');
+        if (bang != std::string_view::npos)
+        {
+            out.user = pfx.substr(bang + 1);
+            pfx = pfx.substr(0, bang);
+        }
+        out.nick = pfx;
+    }
+
+    out.command = word();
+    if (out.command.empty())
+        return false;
+    out.commandId = ircCommandFromName(out.command);
+
+    // Parameters
+    while (out.paramCount < MaxParams)
+    {
+        skipSpaces();
+        if (pos >= len)
+            break;
+
+        // ":trailing", or the 15th parameter which takes the rest of the line
+        if (line[pos] == ':' || out.paramCount == MaxParams - 1)
+        {
+            if (line[pos] == ':')
+            {
+                ++pos;
+                out.hasTrailing = true;
+            }
+            out.params[out.paramCount++] = line.substr(pos);
+            break;
+        }
+
+        out.params[out.paramCount++] = word();
+    }
+
+    return true;
+}
+
+// ----------------------
+// IrcLine implementation
+// ----------------------
+
+IrcLine::IrcLine(const IrcMessage& parsed)
+{
+    assign(parsed, std::string(parsed.raw));
+}
+
+IrcLine::IrcLine(const IrcLine& other)
+{
+    assign(other.msg, other.storage);
+}
+
+IrcLine::IrcLine(IrcLine&& other) noexcept
+{
+    // Moving a short (SSO) string changes its address, so rebase either way
+    assign(other.msg, std::move(other.storage));
+    other.msg = IrcMessage();
+}
+
+IrcLine& IrcLine::operator=(const IrcLine& other)
+{
+    if (this != &other)
+        assign(other.msg, other.storage);
+    return *this;
+}
+
+IrcLine& IrcLine::operator=(IrcLine&& other) noexcept
+{
+    if (this != &other)
+    {
+        assign(other.msg, std::move(other.storage));
+        other.msg = IrcMessage();
+    }
+    return *this;
+}
+
+void IrcLine::assign(const IrcMessage& parsed, std::string text)
+{
+    // Offsets are taken relative to the source line before it goes away
+    const char* oldBase = parsed.raw.data();
+    IrcMessage rebased = parsed;
+
+    storage = std::move(text);
+    const char* newBase = storage.data();
+
+    auto rebase = [&](std::string_view& view) {
+        if (view.data() == nullptr)
+            return;
+        view = std::string_view(newBase + (view.data() - oldBase), view.size());
+    };
+
+    rebase(rebased.raw);
+    rebase(rebased.tags);
+    rebase(rebased.prefix);
+    rebase(rebased.nick);
+    rebase(rebased.user);
+    rebase(rebased.host);
+    rebase(rebased.command);
+    for (std::size_t i = 0; i < rebased.paramCount; ++i)
+        rebase(rebased.params[i]);
+
+    msg = rebased;
+}
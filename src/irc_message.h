@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "irc_commands.h"
+
+// -------------------------------------------------------
+// IrcMessage
+// One parsed IRC line: [@tags] [:nick!user@host] COMMAND params [:trailing]
+// Every field is a view into the parsed line, so parsing never allocates.
+// The views are only valid while the line's storage is; use IrcLine to
+// keep a message alive across threads.
+// -------------------------------------------------------
+
+struct IrcMessage
+{
+    // RFC 1459/2812: at most 15 parameters, the last one may be trailing
+    static constexpr std::size_t MaxParams = 15;
+
+    std::string_view raw;       // the whole line, without CRLF
+    std::string_view tags;      // IRCv3 tags, without the leading '@'
+    std::string_view prefix;    // without the leading ':'
+    std::string_view nick;      // prefix split into nick!user@host
+    std::string_view user;
+    std::string_view host;
+    std::string_view command;
+    IrcCommand commandId = IrcCommand::Unknown;  // resolved once by parse()
+    std::array<std::string_view, MaxParams> params{};
+    std::size_t paramCount = 0;
+    bool hasTrailing = false;   // last param was introduced by " :"
+
+    // Parse one line (without CRLF). Returns false if it has no command.
+    static bool parse(std::string_view line, IrcMessage& out);
+
+    // Parameter i, or an empty view if there are not that many
+    std::string_view param(std::size_t i) const
+    {
+        return i < paramCount ? params[i] : std::string_view();
+    }
+
+    // Last parameter if it was a ":trailing" one, else empty
+    std::string_view trailing() const
+    {
+        return hasTrailing ? params[paramCount - 1] : std::string_view();
+    }
+
+    // Number of parameters before the trailing one
+    std::size_t middleCount() const
+    {
+        return hasTrailing ? paramCount - 1 : paramCount;
+    }
+};
+
+// -------------------------------------------------------
+// IrcLine
+// Owns a copy of a raw line together with its parsed IrcMessage. Copying
+// re-points the views at the new storage instead of parsing again, so a
+// line parsed on the network thread can be handed to the GUI as-is.
+// -------------------------------------------------------
+
+class IrcLine
+{
+public:
+    IrcLine() = default;
+    explicit IrcLine(const IrcMessage& parsed);
+
+    IrcLine(const IrcLine& other);
+    IrcLine(IrcLine&& other) noexcept;
+    IrcLine& operator=(const IrcLine& other);
+    IrcLine& operator=(IrcLine&& other) noexcept;
+
+    const IrcMessage& message() const { return msg; }
+    const std::string& rawLine() const { return storage; }
+
+private:
+    void assign(const IrcMessage& parsed, std::string text);
+
+    std::string storage;
+    IrcMessage msg;
+};
@@ -0,0 +1,443 @@
+#include "irc_reactor.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+#ifdef __linux__
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+#elif defined(_WIN32)
+    #include <ws2tcpip.h>
+    #define POLL_SOCKETS(fds, n, timeout) WSAPoll(fds, n, timeout)
+#else
+    #include <poll.h>
+    #define POLL_SOCKETS(fds, n, timeout) poll(fds, n, timeout)
+#endif
+
+// Marks the wakeup channel in the readiness results
+static constexpr IRCReactor::Token WakeupToken = ~IRCReactor::Token{ 0 };
+
+// ----------------------
+// IRCReactor implementation
+// ----------------------
+
+IRCReactor& IRCReactor::instance()
+{
+    static IRCReactor reactor;
+    return reactor;
+}
+
+IRCReactor::IRCReactor()
+{
+#ifdef __linux__
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0)
+    {
+        std::cerr << "[IRCReactor] epoll/eventfd setup failed: " << errno << std::endl;
+    }
+    else
+    {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = WakeupToken;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+    }
+#elif defined(_WIN32)
+    // WSAPoll only waits on sockets, so wake it with a datagram to ourselves
+    wakeSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (wakeSock != InvalidSocket)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int len = sizeof(addr);
+        if (bind(wakeSock, reinterpret_cast<sockaddr*>(&addr), len) != 0 ||
+            getsockname(wakeSock, reinterpret_cast<sockaddr*>(&addr), &len) != 0 ||
+            connect(wakeSock, reinterpret_cast<sockaddr*>(&addr), len) != 0)
+        {
+            std::cerr << "[IRCReactor] wakeup socket setup failed: " << WSAGetLastError() << std::endl;
+        }
+        setSocketNonBlocking(wakeSock);
+    }
+#else
+    if (pipe(wakePipe) == 0)
+    {
+        fcntl(wakePipe[0], F_SETFL, fcntl(wakePipe[0], F_GETFL, 0) | O_NONBLOCK);
+        fcntl(wakePipe[1], F_SETFL, fcntl(wakePipe[1], F_GETFL, 0) | O_NONBLOCK);
+    }
+    else
+    {
+        std::cerr << "[IRCReactor] pipe() failed: " << errno << std::endl;
+    }
+#endif
+
+    running = true;
+    thread = std::thread(&IRCReactor::run, this);
+}
+
+IRCReactor::~IRCReactor()
+{
+    running = false;
+    signalWakeup();
+
+    if (thread.joinable())
+        thread.join();
+
+#ifdef __linux__
+    if (wakeFd >= 0)
+        close(wakeFd);
+    if (epollFd >= 0)
+        close(epollFd);
+#elif defined(_WIN32)
+    if (wakeSock != InvalidSocket)
+        closesocket(wakeSock);
+#else
+    if (wakePipe[0] >= 0)
+        close(wakePipe[0]);
+    if (wakePipe[1] >= 0)
+        close(wakePipe[1]);
+#endif
+}
+
+bool IRCReactor::isReactorThread() const
+{
+    return std::this_thread::get_id() == thread.get_id();
+}
+
+std::unique_lock<std::recursive_mutex> IRCReactor::lockCallbacks()
+{
+    return std::unique_lock<std::recursive_mutex>(mutex);
+}
+
+bool IRCReactor::add(SocketType sock, Handler* handler, std::atomic<Token>& token)
+{
+    if (sock == InvalidSocket || !handler)
+        return false;
+
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    Token newToken = nextToken++;
+
+    Registration reg{ sock, handler, true, false, false };
+#ifdef __linux__
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.u64 = newToken;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, sock, &ev) != 0)
+        return false;
+    reg.polled = true;
+#endif
+
+    registrations[newToken] = reg;
+    token = newToken;
+
+#ifndef __linux__
+    // The poll set is rebuilt on every pass; make the loop pick this one up
+    signalWakeup();
+#endif
+    return true;
+}
+
+void IRCReactor::remove(Token token)
+{
+    // Taking the lock also waits for any callback currently running for
+    // this registration on the reactor thread
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    auto it = registrations.find(token);
+    if (it == registrations.end())
+        return;
+
+#ifdef __linux__
+    if (it->second.polled)
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.sock, nullptr);
+#endif
+
+    registrations.erase(it);
+}
+
+void IRCReactor::notify(Token token)
+{
+    if (token == InvalidToken)
+        return;
+
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(notifyMutex);
+        first = pendingNotify.empty();
+        pendingNotify.push_back(token);
+    }
+
+    // Only the first notify since the last drain needs to poke the loop
+    if (first)
+        signalWakeup();
+}
+
+void IRCReactor::notifyAt(Token token, std::chrono::steady_clock::time_point when)
+{
+    if (token == InvalidToken)
+        return;
+
+    bool earliest;
+    {
+        std::lock_guard<std::mutex> lock(notifyMutex);
+        earliest = timers.empty() || when < timers.front().first;
+        timers.emplace_back(when, token);
+        std::push_heap(timers.begin(), timers.end(), std::greater<>());
+    }
+
+    // The loop's current wait was computed from the old earliest deadline
+    if (earliest && !isReactorThread())
+        signalWakeup();
+}
+
+int IRCReactor::waitTimeoutMs()
+{
+    std::lock_guard<std::mutex> lock(notifyMutex);
+    if (timers.empty())
+        return -1;
+
+    auto wait = timers.front().first - std::chrono::steady_clock::now();
+    if (wait <= wait.zero())
+        return 0;
+
+    // Round up so we never wake just before the deadline and spin
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+    return static_cast<int>(std::min<decltype(ms)>(ms, 60 * 1000));
+}
+
+void IRCReactor::collectNotified(std::vector<Token>& out, bool woken)
+{
+    std::lock_guard<std::mutex> lock(notifyMutex);
+
+    if (woken)
+        out.swap(pendingNotify);
+
+    auto now = std::chrono::steady_clock::now();
+    while (!timers.empty() && timers.front().first <= now)
+    {
+        std::pop_heap(timers.begin(), timers.end(), std::greater<>());
+        out.push_back(timers.back().second);
+        timers.pop_back();
+    }
+}
+
+void IRCReactor::setWriteInterest(Token token, bool enabled)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    auto it = registrations.find(token);
+    if (it == registrations.end() || it->second.wantWrite == enabled)
+        return;
+
+    it->second.wantWrite = enabled;
+    updateInterest(token, it->second);
+}
+
+void IRCReactor::setReadInterest(Token token, bool enabled)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    auto it = registrations.find(token);
+    if (it == registrations.end() || it->second.wantRead == enabled)
+        return;
+
+    it->second.wantRead = enabled;
+    updateInterest(token, it->second);
+}
+
+void IRCReactor::updateInterest(Token token, Registration& reg)
+{
+    // Caller holds the lock
+#ifdef __linux__
+    // epoll always reports hangups, even for an empty event mask, so a
+    // socket with no interest at all leaves the set until it wants events
+    if (!reg.wantRead && !reg.wantWrite)
+    {
+        if (reg.polled)
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, reg.sock, nullptr);
+        reg.polled = false;
+        return;
+    }
+
+    epoll_event ev{};
+    ev.events = (reg.wantRead ? (EPOLLIN | EPOLLRDHUP) : 0u) | (reg.wantWrite ? EPOLLOUT : 0u);
+    ev.data.u64 = token;
+    epoll_ctl(epollFd, reg.polled ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, reg.sock, &ev);
+    reg.polled = true;
+#else
+    (void)token;
+    (void)reg;
+    // The poll set is rebuilt on every pass
+    if (!isReactorThread())
+        signalWakeup();
+#endif
+}
+
+void IRCReactor::signalWakeup()
+{
+#ifdef __linux__
+    std::uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;  // EAGAIN means the counter is already non-zero
+#elif defined(_WIN32)
+    char byte = 0;
+    send(wakeSock, &byte, 1, 0);
+#else
+    char byte = 0;
+    ssize_t written = write(wakePipe[1], &byte, 1);
+    (void)written;  // a full pipe already guarantees a wakeup
+#endif
+}
+
+void IRCReactor::drainWakeup()
+{
+#ifdef __linux__
+    std::uint64_t value;
+    ssize_t got = read(wakeFd, &value, sizeof(value));
+    (void)got;
+#elif defined(_WIN32)
+    char buf[64];
+    while (recv(wakeSock, buf, sizeof(buf), 0) > 0)
+    {
+    }
+#else
+    char buf[64];
+    while (read(wakePipe[0], buf, sizeof(buf)) > 0)
+    {
+    }
+#endif
+}
+
+void IRCReactor::dispatch(Token token, Event event)
+{
+    // Caller holds the lock. Look the token up again: an earlier callback in
+    // this batch may have removed it.
+    auto it = registrations.find(token);
+    if (it == registrations.end())
+        return;
+
+    switch (event)
+    {
+    case Event::Readable:
+        // With reading paused this can only be a hangup or error; let a
+        // pending write discover it
+        if (it->second.wantRead)
+            it->second.handler->onReadable();
+        else if (it->second.wantWrite)
+            it->second.handler->onWritable();
+        break;
+    case Event::Writable:
+        it->second.handler->onWritable();
+        break;
+    case Event::Notify:
+        it->second.handler->onNotify();
+        break;
+    }
+}
+
+void IRCReactor::run()
+{
+    std::vector<std::pair<Token, Event>> ready;
+    std::vector<Token> notified;
+    bool woken = false;
+
+#ifdef __linux__
+    std::vector<epoll_event> events(64);
+#else
+    std::vector<pollfd> fds;
+    std::vector<Token> fdTokens;
+#endif
+
+    while (running.load())
+    {
+        ready.clear();
+        woken = false;
+
+#ifdef __linux__
+        int n = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), waitTimeoutMs());
+        if (n < 0 && errno != EINTR)
+        {
+            std::cerr << "[IRCReactor] epoll_wait failed: " << errno << std::endl;
+            break;
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            Token token = events[i].data.u64;
+            if (token == WakeupToken)
+            {
+                woken = true;
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                ready.emplace_back(token, Event::Readable);
+            if (events[i].events & EPOLLOUT)
+                ready.emplace_back(token, Event::Writable);
+        }
+#else
+        fds.clear();
+        fdTokens.clear();
+        {
+            pollfd wake{};
+    #ifdef _WIN32
+            wake.fd = wakeSock;
+    #else
+            wake.fd = wakePipe[0];
+    #endif
+            wake.events = POLLIN;
+            fds.push_back(wake);
+            fdTokens.push_back(WakeupToken);
+
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+            for (const auto& [token, reg] : registrations)
+            {
+                // poll() reports hangups regardless of events; leave idle
+                // sockets out entirely
+                if (!reg.wantRead && !reg.wantWrite)
+                    continue;
+
+                pollfd pfd{};
+                pfd.fd = reg.sock;
+                pfd.events = (reg.wantRead ? POLLIN : 0) | (reg.wantWrite ? POLLOUT : 0);
+                fds.push_back(pfd);
+                fdTokens.push_back(token);
+            }
+        }
+
+        int n = POLL_SOCKETS(fds.data(), static_cast<unsigned long>(fds.size()), waitTimeoutMs());
+        if (n > 0)
+        {
+            for (std::size_t i = 0; i < fds.size(); ++i)
+            {
+                short revents = fds[i].revents;
+                if (revents == 0)
+                    continue;
+                if (fdTokens[i] == WakeupToken)
+                {
+                    woken = true;
+                    continue;
+                }
+                if (revents & (POLLIN | POLLHUP | POLLERR))
+                    ready.emplace_back(fdTokens[i], Event::Readable);
+                if (revents & POLLOUT)
+                    ready.emplace_back(fdTokens[i], Event::Writable);
+            }
+        }
+#endif
+
+        notified.clear();
+        if (woken)
+            drainWakeup();
+        collectNotified(notified, woken);
+
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+
+        for (const auto& [token, event] : ready)
+            dispatch(token, event);
+
+        for (Token token : notified)
+            dispatch(token, Event::Notify);
+    }
+}
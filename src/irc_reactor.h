@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "irc_socket.h"
+
+// -------------------------------------------------------
+// IRCReactor
+// Process-wide I/O loop. One thread multiplexes the sockets of every
+// IRCCore (epoll on Linux, poll()/WSAPoll() elsewhere), so the thread and
+// wakeup count stays flat no matter how many networks are connected.
+// The loop sleeps until a socket is ready, notify() is called or a
+// notifyAt() deadline passes; there is no polling interval.
+// -------------------------------------------------------
+
+class IRCReactor
+{
+public:
+    // Implemented by anything that owns a socket registered with the reactor.
+    // Callbacks always run on the reactor thread.
+    class Handler
+    {
+    public:
+        virtual ~Handler() = default;
+
+        // The socket has data (or EOF/error) to read
+        virtual void onReadable() = 0;
+
+        // The socket can take more output (only while write interest is set)
+        virtual void onWritable() = 0;
+
+        // notify() was called for this registration, e.g. output was queued
+        virtual void onNotify() = 0;
+    };
+
+    using Token = std::uint64_t;
+    static constexpr Token InvalidToken = 0;
+
+    static IRCReactor& instance();
+
+    // Non-copyable, non-movable (owns the I/O thread)
+    IRCReactor(const IRCReactor&) = delete;
+    IRCReactor& operator=(const IRCReactor&) = delete;
+
+    // Start watching a non-blocking socket. The registration token is stored
+    // into `token` before any callback can fire; returns false on failure.
+    bool add(SocketType sock, Handler* handler, std::atomic<Token>& token);
+
+    // Stop watching. Once this returns, the handler will not be called again
+    // for this registration. Safe to call from inside a handler callback.
+    void remove(Token token);
+
+    // Wake the loop and call onNotify() for this registration. Thread-safe;
+    // several notify() calls before the loop runs collapse into one wakeup.
+    void notify(Token token);
+
+    // Call onNotify() for this registration once `when` has passed, e.g. when
+    // flood control allows the next line. Thread-safe; timers are one-shot
+    // and a timer for a removed registration is silently dropped.
+    void notifyAt(Token token, std::chrono::steady_clock::time_point when);
+
+    // Ask for onWritable() while the socket's send buffer is full
+    void setWriteInterest(Token token, bool enabled);
+
+    // Stop or resume onReadable() for a socket, e.g. while the consumer of
+    // its input is full. A hangup seen while reading is off is reported
+    // through onWritable() if write interest is set, else on resume.
+    void setReadInterest(Token token, bool enabled);
+
+    bool isReactorThread() const;
+
+    // Hold off every callback while the caller changes state its handlers
+    // share. Reentrant: the reactor thread itself already holds it during
+    // callbacks, and add()/remove()/... may be called while holding it.
+    std::unique_lock<std::recursive_mutex> lockCallbacks();
+
+private:
+    IRCReactor();
+    ~IRCReactor();
+
+    void run();
+    int waitTimeoutMs();
+    void collectNotified(std::vector<Token>& out, bool woken);
+    void signalWakeup();
+    void drainWakeup();
+
+private:
+    struct Registration
+    {
+        SocketType sock{ InvalidSocket };
+        Handler* handler{ nullptr };
+        bool wantRead{ true };
+        bool wantWrite{ false };
+        bool polled{ false };  // currently in the epoll set
+    };
+
+    enum class Event
+    {
+        Readable,
+        Writable,
+        Notify
+    };
+
+    void dispatch(Token token, Event event);
+    void updateInterest(Token token, Registration& reg);
+
+    std::thread thread;
+    std::atomic<bool> running{ false };
+
+    // Held while dispatching so remove() can wait out an in-flight callback
+    mutable std::recursive_mutex mutex;
+    std::unordered_map<Token, Registration> registrations;
+    Token nextToken{ 1 };
+
+    // Registrations with a pending notify(); guarded separately so producers
+    // never wait for a dispatch in progress
+    std::mutex notifyMutex;
+    std::vector<Token> pendingNotify;
+
+    // notifyAt() deadlines as a min-heap (earliest on top), under notifyMutex
+    using Timer = std::pair<std::chrono::steady_clock::time_point, Token>;
+    std::vector<Timer> timers;
+
+    // Wakeup channel: eventfd on Linux, a self-connected UDP socket on
+    // Windows, a self-pipe elsewhere
+#ifdef __linux__
+    int epollFd{ -1 };
+    int wakeFd{ -1 };
+#elif defined(_WIN32)
+    SocketType wakeSock{ InvalidSocket };
+#else
+    int wakePipe[2]{ -1, -1 };
+#endif
+};
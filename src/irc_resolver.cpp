@@ -0,0 +1,241 @@
+#include "irc_resolver.h"
+
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+    #include <ws2tcpip.h>
+#else
+    #include <netdb.h>
+    #include <netinet/in.h>
+#endif
+
+// Enough that one host stuck on a dead DNS server doesn't hold up the rest
+static constexpr int WorkerCount = 2;
+
+// ----------------------
+// IRCResolver implementation
+// ----------------------
+
+IRCResolver& IRCResolver::instance()
+{
+    static IRCResolver resolver;
+    return resolver;
+}
+
+IRCResolver::IRCResolver()
+{
+#ifdef _WIN32
+    // May be used (e.g. for prefetching) before any IRCCore has started Winsock
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    for (int i = 0; i < WorkerCount; ++i)
+        workers.emplace_back(&IRCResolver::workerLoop, this);
+}
+
+IRCResolver::~IRCResolver()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+
+    for (auto& worker : workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+IRCResolver::RequestId IRCResolver::resolve(const std::string& host, int port, ResolveCallback callback)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    auto cached = cache.find(host);
+    if (cached != cache.end() && cached->second.expires > std::chrono::steady_clock::now())
+    {
+        CacheEntry entry = cached->second;
+        lock.unlock();
+
+        callback(withPort(std::move(entry.addresses), port), entry.error);
+        return InvalidRequest;
+    }
+
+    RequestId id = nextId++;
+    auto [it, firstWaiter] = waiting.try_emplace(host);
+    it->second.push_back(Waiter{ id, port, std::move(callback) });
+
+    // Piggyback on a lookup already running for this host (prefetch, or
+    // another connection reconnecting at the same time)
+    if (firstWaiter)
+    {
+        jobs.push_back(host);
+        jobReady.notify_one();
+    }
+    return id;
+}
+
+void IRCResolver::cancel(RequestId id)
+{
+    if (id == InvalidRequest)
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto& [host, waiters] : waiting)
+    {
+        for (auto it = waiters.begin(); it != waiters.end(); ++it)
+        {
+            if (it->id == id)
+            {
+                waiters.erase(it);
+                return;
+            }
+        }
+    }
+
+    if (answered.erase(id) > 0)
+        return;
+
+    // Wait out a callback in progress, unless we are inside it
+    callbackDone.wait(lock, [this, id] {
+        auto it = running.find(id);
+        return it == running.end() || it->second == std::this_thread::get_id();
+    });
+}
+
+void IRCResolver::prefetch(const std::string& host)
+{
+    if (host.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto cached = cache.find(host);
+    if (cached != cache.end() && cached->second.expires > std::chrono::steady_clock::now())
+        return;
+
+    if (waiting.try_emplace(host).second)
+    {
+        jobs.push_back(host);
+        jobReady.notify_one();
+    }
+}
+
+void IRCResolver::lookup(const std::string& host, CacheEntry& entry)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;      // IPv4 or IPv6
+    hints.ai_socktype = SOCK_STREAM;  // TCP
+    hints.ai_protocol = IPPROTO_TCP;
+
+    // No service: the answer is shared by every port, withPort() fills it in
+    addrinfo* result = nullptr;
+    int res = getaddrinfo(host.c_str(), nullptr, &hints, &result);
+    if (res != 0 || !result)
+    {
+        entry.error = "getaddrinfo failed: " + std::string(gai_strerror(res));
+        return;
+    }
+
+    for (addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next)
+    {
+        if (ptr->ai_addrlen > sizeof(sockaddr_storage))
+            continue;
+
+        ConnectAddress address;
+        std::memcpy(&address.addr, ptr->ai_addr, ptr->ai_addrlen);
+        address.addrLen = static_cast<int>(ptr->ai_addrlen);
+        address.family = ptr->ai_family;
+        entry.addresses.push_back(address);
+    }
+
+    freeaddrinfo(result);
+
+    if (entry.addresses.empty())
+        entry.error = "no usable addresses";
+}
+
+std::vector<ConnectAddress> IRCResolver::withPort(std::vector<ConnectAddress> addresses, int port)
+{
+    for (ConnectAddress& address : addresses)
+    {
+        if (address.family == AF_INET)
+            reinterpret_cast<sockaddr_in*>(&address.addr)->sin_port = htons(static_cast<unsigned short>(port));
+        else if (address.family == AF_INET6)
+            reinterpret_cast<sockaddr_in6*>(&address.addr)->sin6_port = htons(static_cast<unsigned short>(port));
+    }
+    return addresses;
+}
+
+void IRCResolver::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (stopping)
+            return;
+
+        std::string host = std::move(jobs.front());
+        jobs.pop_front();
+
+        lock.unlock();
+        CacheEntry entry;
+        lookup(host, entry);
+        auto now = std::chrono::steady_clock::now();
+        lock.lock();
+
+        CacheEntry& cached = cache[host];
+        if (!entry.addresses.empty())
+        {
+            entry.expires = now + CacheTtl;
+            cached = std::move(entry);
+        }
+        else if (!cached.addresses.empty())
+        {
+            // Keep serving the last good answer; try again a little later
+            cached.expires = now + NegativeCacheTtl;
+        }
+        else
+        {
+            entry.expires = now + NegativeCacheTtl;
+            cached = std::move(entry);
+        }
+        CacheEntry answer = cached;
+
+        std::vector<RequestId> ids;
+        auto it = waiting.find(host);
+        if (it != waiting.end())
+        {
+            for (Waiter& waiter : it->second)
+            {
+                ids.push_back(waiter.id);
+                answered.emplace(waiter.id, std::move(waiter));
+            }
+            waiting.erase(it);
+        }
+
+        // Deliver outside the state lock (callbacks may resolve again),
+        // skipping requests cancelled in the meantime
+        for (RequestId id : ids)
+        {
+            auto node = answered.extract(id);
+            if (node.empty())
+                continue;
+
+            running.emplace(id, std::this_thread::get_id());
+            lock.unlock();
+            node.mapped().callback(withPort(answer.addresses, node.mapped().port), answer.error);
+            lock.lock();
+            running.erase(id);
+            callbackDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "irc_connector.h"
+
+// -------------------------------------------------------
+// IRCResolver
+// Process-wide asynchronous host lookup with an in-memory cache. Lookups
+// run on a couple of worker threads (getaddrinfo() has no portable async
+// form), concurrent requests for the same host share one lookup, and
+// answers are kept for CacheTtl so reconnects start from cached addresses.
+// If a refresh fails, the last good answer is served instead, so a local
+// network blip doesn't turn into failed reconnects.
+// -------------------------------------------------------
+
+class IRCResolver
+{
+public:
+    // Addresses ready to connect to (port filled in), or empty and a reason
+    using ResolveCallback = std::function<void(std::vector<ConnectAddress> addresses, const std::string& error)>;
+    using RequestId = std::uint64_t;
+    static constexpr RequestId InvalidRequest = 0;
+
+    // getaddrinfo() doesn't expose record TTLs, so answers live this long
+    static constexpr std::chrono::seconds CacheTtl{ 300 };
+    static constexpr std::chrono::seconds NegativeCacheTtl{ 10 };
+
+    static IRCResolver& instance();
+
+    // Non-copyable, non-movable (owns the worker threads)
+    IRCResolver(const IRCResolver&) = delete;
+    IRCResolver& operator=(const IRCResolver&) = delete;
+
+    // Look up `host`. A fresh cached answer is delivered before this
+    // returns (and InvalidRequest is returned); otherwise the callback runs
+    // on a resolver thread once the lookup finishes.
+    RequestId resolve(const std::string& host, int port, ResolveCallback callback);
+
+    // Drop a pending request. Once this returns its callback is not running
+    // and will not be called. Safe to call from inside any resolve callback.
+    void cancel(RequestId id);
+
+    // Warm the cache without waiting for the answer
+    void prefetch(const std::string& host);
+
+private:
+    IRCResolver();
+    ~IRCResolver();
+
+    struct CacheEntry
+    {
+        std::vector<ConnectAddress> addresses;  // port 0; empty if the lookup failed
+        std::string error;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    struct Waiter
+    {
+        RequestId id;
+        int port;
+        ResolveCallback callback;
+    };
+
+    void workerLoop();
+    void lookup(const std::string& host, CacheEntry& entry);
+    static std::vector<ConnectAddress> withPort(std::vector<ConnectAddress> addresses, int port);
+
+    std::vector<std::thread> workers;
+    bool stopping{ false };
+
+    // Guards everything below
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::deque<std::string> jobs;                                 // hosts to look up
+    std::unordered_map<std::string, std::vector<Waiter>> waiting; // host -> requests sharing its lookup
+    std::unordered_map<RequestId, Waiter> answered;               // looked up, callback not started
+    std::unordered_map<RequestId, std::thread::id> running;       // callback in progress, and where
+    std::condition_variable callbackDone;
+    std::unordered_map<std::string, CacheEntry> cache;
+    RequestId nextId{ 1 };
+};
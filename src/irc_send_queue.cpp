@@ -0,0 +1,63 @@
+#include "irc_send_queue.h"
+
+#include <utility>
+
+// ----------------------
+// IRCSendQueue implementation
+// ----------------------
+
+IRCSendQueue::~IRCSendQueue()
+{
+    clear();
+}
+
+void IRCSendQueue::push(OutgoingLine line)
+{
+    Node* node = new Node{ std::move(line), top.load(std::memory_order_relaxed) };
+
+    // No ABA here: the consumer only ever detaches the whole chain
+    while (!top.compare_exchange_weak(node->next, node,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed))
+    {
+    }
+}
+
+bool IRCSendQueue::empty() const
+{
+    return top.load(std::memory_order_acquire) == nullptr;
+}
+
+void IRCSendQueue::popAll(std::deque<OutgoingLine>& out)
+{
+    Node* chain = top.exchange(nullptr, std::memory_order_acquire);
+
+    // Reverse into push order
+    Node* oldestFirst = nullptr;
+    while (chain)
+    {
+        Node* next = chain->next;
+        chain->next = oldestFirst;
+        oldestFirst = chain;
+        chain = next;
+    }
+
+    while (oldestFirst)
+    {
+        Node* next = oldestFirst->next;
+        out.push_back(std::move(oldestFirst->line));
+        delete oldestFirst;
+        oldestFirst = next;
+    }
+}
+
+void IRCSendQueue::clear()
+{
+    Node* chain = top.exchange(nullptr, std::memory_order_acquire);
+    while (chain)
+    {
+        Node* next = chain->next;
+        delete chain;
+        chain = next;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include "irc_flood_control.h"
+
+// -------------------------------------------------------
+// IRCSendQueue
+// Lock-free multi-producer queue of outgoing lines. Any thread may push;
+// one consumer (the reactor thread, or whoever owns the connection once
+// it has left the reactor) takes everything queued so far in one atomic
+// exchange. Producers never wait for the consumer or for each other.
+// -------------------------------------------------------
+
+struct OutgoingLine
+{
+    std::string data;  // including CRLF
+    std::chrono::steady_clock::time_point queuedAt;
+    SendPriority priority{ SendPriority::Interactive };
+};
+
+class IRCSendQueue
+{
+public:
+    IRCSendQueue() = default;
+    ~IRCSendQueue();
+
+    // Non-copyable, non-movable (shared between threads)
+    IRCSendQueue(const IRCSendQueue&) = delete;
+    IRCSendQueue& operator=(const IRCSendQueue&) = delete;
+
+    // Any thread
+    void push(OutgoingLine line);
+    bool empty() const;
+
+    // Consumer only. Appends every line pushed so far to `out`, oldest first.
+    void popAll(std::deque<OutgoingLine>& out);
+
+    // Consumer only. Drops everything queued.
+    void clear();
+
+private:
+    struct Node
+    {
+        OutgoingLine line;
+        Node* next;
+    };
+
+    // Newest first; the consumer reverses a detached chain
+    std::atomic<Node*> top{ nullptr };
+};
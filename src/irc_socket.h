@@ -0,0 +1,110 @@
+#pragma once
+
+// Platform socket layer shared by IRCCore and IRCReactor
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <winsock2.h>
+    using SocketType = SOCKET;
+    constexpr SocketType InvalidSocket = INVALID_SOCKET;
+    using SocketBuffer = WSABUF;
+#else
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+    using SocketType = int;
+    constexpr SocketType InvalidSocket = -1;
+    using SocketBuffer = iovec;
+#endif
+
+#include <cstddef>
+
+// Put a socket into non-blocking mode. Every socket owned by the reactor
+// must be non-blocking, otherwise one slow peer would stall all connections.
+inline bool setSocketNonBlocking(SocketType s)
+{
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    if (flags < 0)
+        return false;
+    return fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// True if the last socket call failed only because it would have blocked
+inline bool socketWouldBlock()
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+// True if a non-blocking connect() failed only because it is still in progress
+inline bool socketConnectInProgress()
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EINPROGRESS || errno == EINTR;
+#endif
+}
+
+// Pending error of a socket (e.g. the outcome of a non-blocking connect);
+// 0 if there is none
+inline int socketPendingError(SocketType s)
+{
+    int error = 0;
+#ifdef _WIN32
+    int len = sizeof(error);
+    if (getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &len) != 0)
+        return WSAGetLastError();
+#else
+    socklen_t len = sizeof(error);
+    if (getsockopt(s, SOL_SOCKET, SO_ERROR, &error, &len) != 0)
+        return errno;
+#endif
+    return error;
+}
+
+// Point one gather-write slot at a run of bytes
+inline void setSocketBuffer(SocketBuffer& buffer, const char* data, std::size_t size)
+{
+#ifdef _WIN32
+    buffer.buf = const_cast<char*>(data);
+    buffer.len = static_cast<ULONG>(size);
+#else
+    buffer.iov_base = const_cast<char*>(data);
+    buffer.iov_len = size;
+#endif
+}
+
+// Write several buffers with one system call (sendmsg/WSASend). Returns the
+// number of bytes accepted, which may end mid-buffer, or -1 on error.
+inline long sendBuffers(SocketType s, SocketBuffer* buffers, std::size_t count)
+{
+#ifdef _WIN32
+    DWORD sent = 0;
+    if (WSASend(s, buffers, static_cast<DWORD>(count), &sent, 0, nullptr, nullptr) != 0)
+        return -1;
+    return static_cast<long>(sent);
+#else
+    msghdr msg{};
+    msg.msg_iov = buffers;
+    msg.msg_iovlen = count;
+    #ifdef MSG_NOSIGNAL
+    // Don't let a peer reset raise SIGPIPE; report the error instead
+    return static_cast<long>(sendmsg(s, &msg, MSG_NOSIGNAL));
+    #else
+    return static_cast<long>(sendmsg(s, &msg, 0));
+    #endif
+#endif
+}